@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <opencv2/opencv.hpp>
+
+namespace bench {
+
+  // Average wall time of fn in milliseconds, after one untimed warm-up call.
+  template <typename Fn>
+  double timeMs(Fn&& fn, int iterations) {
+      fn();
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; i++) fn();
+      auto end = std::chrono::steady_clock::now();
+      return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+  }
+
+  inline cv::Mat randomImage(int rows, int cols) {
+      cv::Mat image(rows, cols, CV_32F);
+      cv::randu(image, 0.0, 255.0);
+      cv::GaussianBlur(image, image, cv::Size(0, 0), 2.0);
+      return image;
+  }
+
+  inline int argOr(int argc, char** argv, int idx, int fallback) {
+      return argc > idx ? std::atoi(argv[idx]) : fallback;
+  }
+
+  inline void report(const std::string& name, double ms, double baseline_ms = 0.0) {
+      std::cout << std::left << std::setw(44) << name << std::right << std::setw(10) << std::fixed << std::setprecision(3) << ms << " ms";
+      if (baseline_ms > 0.0) std::cout << "   x" << std::setprecision(2) << baseline_ms / ms;
+      std::cout << '\n';
+  }
+
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <utility>
+#include <opencv2/opencv.hpp>
+#include "benchUtils.hpp"
+#include "scaleSpace.hpp"
+#include "dog.hpp"
+#include "refine.hpp"
+#include "descriptor.hpp"
+
+int main(int argc, char** argv) {
+    const int rows = bench::argOr(argc, argv, 1, 1080);
+    const int cols = bench::argOr(argc, argv, 2, 1920);
+    const int iterations = bench::argOr(argc, argv, 3, 3);
+
+    cfg::SiftConfig config;
+    config.contrast_threshold = 0.01f;
+    cv::Mat image = bench::randomImage(rows, cols);
+    ss::ScaleSpace gaussian, DoG;
+    ss::prepareScaleSpace(gaussian, image, config.numOctavesFor(image.size()), config.scales_per_octave, config.initial_scale);
+    dog::calculateDifferenceOfGaussians(gaussian, DoG);
+
+    kp::KeyPointSet keypoints;
+    refine::detectAndRefine(DoG, config, keypoints);
+    std::cout << "Image " << cols << "x" << rows << ", " << keypoints.size() << " keypoints\n\n";
+
+    auto throughput = [&](double ms) {
+        std::cout << "    " << std::fixed << std::setprecision(0) << keypoints.size() / (ms / 1000.0) << " keypoints/s\n";
+    };
+
+    // One keypoint at a time in detection order, as main.cpp did
+    std::vector<desc::Desc> one_by_one;
+    double t_loop = bench::timeMs([&] { one_by_one = desc::describeKeypoints(gaussian, keypoints, config); }, iterations);
+    bench::report("describeKeypoints (detection order)", t_loop);
+    throughput(t_loop);
+
+    desc::DescriptorMatrix serial;
+    double t_serial = bench::timeMs([&] { serial = desc::extractDescriptors(gaussian, keypoints, config, exec::serialExecutor()); },
+                                    iterations);
+    bench::report("extractDescriptors (Z-order, serial)", t_serial, t_loop);
+    throughput(t_serial);
+
+    desc::DescriptorMatrix parallel;
+    double t_parallel = bench::timeMs([&] { parallel = desc::extractDescriptors(gaussian, keypoints, config); }, iterations);
+    bench::report("extractDescriptors (Z-order, parallel)", t_parallel, t_loop);
+    throughput(t_parallel);
+
+    // Gradient-magnitude histograms, differentiated per window or gathered from shared level maps
+    cfg::SiftConfig gradient_config = config;
+    gradient_config.histogram_source = cfg::HistogramSource::GradientMagnitude;
+    for (auto [mode, name] : {std::pair{cfg::MapMode::OnDemand, "extractDescriptors (gradient, on demand)"},
+                              std::pair{cfg::MapMode::Precomputed, "extractDescriptors (gradient, level maps)"},
+                              std::pair{cfg::MapMode::Automatic, "extractDescriptors (gradient, automatic)"}}) {
+        gradient_config.map_mode = mode;
+        double t = bench::timeMs([&] { desc::extractDescriptors(gaussian, keypoints, gradient_config); }, iterations);
+        bench::report(name, t, t_loop);
+        throughput(t);
+    }
+
+    bool same = parallel.rows() == static_cast<int>(one_by_one.size()) && serial.rows() == parallel.rows();
+    for (int row = 0; same && row < parallel.rows(); row++) {
+        same = parallel.toDesc(row).descriptor == one_by_one[row].descriptor && serial.toDesc(row).descriptor == one_by_one[row].descriptor;
+    }
+    std::cout << "    " << (same ? "identical" : "MISMATCH") << '\n';
+    return same ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "benchUtils.hpp"
+#include "scaleSpaceBuilder.hpp"
+#include "keypointDetection.hpp"
+#include "keypointSet.hpp"
+#include "refine.hpp"
+
+int main(int argc, char** argv) {
+    const int rows = bench::argOr(argc, argv, 1, 2160);
+    const int cols = bench::argOr(argc, argv, 2, 3840);
+    const int iterations = bench::argOr(argc, argv, 3, 5);
+    const int scales_per_octave = 5;
+    const int num_octaves = static_cast<int>(std::log2(std::min(rows, cols))) - 3;
+    const float contrast_threshold = 0.01f;
+
+    cv::Mat image = bench::randomImage(rows, cols);
+    ss::ScaleSpaceBuilder builder(image.size(), num_octaves, scales_per_octave, 1.6f, false);
+    builder.build(image);
+    const ss::Pyramid& DoG = builder.DoGPyramid();
+    std::cout << "Image " << cols << "x" << rows << ", " << num_octaves << " octaves, " << scales_per_octave << " scales\n\n";
+
+    // The flow main.cpp used: detect over the whole pyramid, then refine the full candidate list
+    kp::KeyPointSet two_pass;
+    double t_two_pass = bench::timeMs([&] {
+        std::vector<kp::KeyPoint> candidates;
+        kp::coarseKeypointDetection(DoG, candidates, contrast_threshold);
+        two_pass = kp::KeyPointSet(candidates);
+        refine::refineKeypoints(DoG, two_pass);
+    }, iterations);
+    bench::report("detect, then refine (serial)", t_two_pass);
+
+    kp::KeyPointSet fused;
+    bench::report("fused per band (serial)", bench::timeMs([&] {
+        fused.clear();
+        refine::detectAndRefine(DoG, contrast_threshold, fused, exec::serialExecutor());
+    }, iterations), t_two_pass);
+
+    kp::KeyPointSet parallel;
+    bench::report("fused per band (cv::parallel_for_)", bench::timeMs([&] {
+        parallel.clear();
+        refine::detectAndRefine(DoG, contrast_threshold, parallel);
+    }, iterations), t_two_pass);
+
+    bool same = fused.size() == two_pass.size() && parallel.size() == two_pass.size();
+    for (size_t i = 0; same && i < two_pass.size(); i++) {
+        same = fused.x()[i] == two_pass.x()[i] && fused.y()[i] == two_pass.y()[i] && parallel.x()[i] == two_pass.x()[i] &&
+               parallel.y()[i] == two_pass.y()[i];
+    }
+    std::cout << "    " << two_pass.size() << " keypoints, " << (same ? "identical" : "MISMATCH") << '\n';
+    return same ? 0 : 1;
+}
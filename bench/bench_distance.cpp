@@ -0,0 +1,49 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include "benchUtils.hpp"
+#include "descriptor.hpp"
+
+// Squared-distance kernels over padded DescriptorMatrix rows, one query row against every row of a set,
+// for several descriptor lengths (complex coefficients). Usage: bench_distance [rows iterations]
+int main(int argc, char** argv) {
+    const int rows = bench::argOr(argc, argv, 1, 4096);
+    const int iterations = bench::argOr(argc, argv, 2, 50);
+
+    std::cout << "Active backend: " << desc::distanceBackendName(desc::activeDistanceBackend()) << "\n\n";
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    bool same = true;
+    for (int cols : {17, 32, 64, 128, 256}) {
+        std::vector<desc::Desc> descs(rows);
+        for (auto& d : descs) {
+            d.descriptor.resize(cols);
+            for (auto& value : d.descriptor) value = {uniform(rng), uniform(rng)};
+        }
+        const desc::DescriptorMatrix matrix = desc::DescriptorMatrix::fromDescs(descs);
+        std::cout << "cols " << cols << " (row stride " << matrix.rowStride() << " floats)\n";
+
+        float reference = 0.0f;
+        double t_scalar = 0.0;
+        for (desc::DistanceBackend backend : {desc::DistanceBackend::Scalar, desc::DistanceBackend::SSE42,
+                                              desc::DistanceBackend::AVX2, desc::DistanceBackend::AVX512}) {
+            if (!desc::distanceBackendSupported(backend)) continue;
+            const desc::SquaredDistanceKernel kernel = desc::squaredDistanceKernel(backend);
+            float total = 0.0f;
+            double t = bench::timeMs([&] {
+                total = 0.0f;
+                for (int j = 0; j < rows; j++) total += kernel(matrix.row(0), matrix.row(j), matrix.rowStride());
+            }, iterations);
+            if (backend == desc::DistanceBackend::Scalar) {
+                reference = total;
+                t_scalar = t;
+            }
+            same = same && std::abs(total - reference) <= 1e-4f * reference;
+            bench::report("  " + desc::distanceBackendName(backend), t, t_scalar);
+        }
+    }
+    std::cout << "\n    " << (same ? "identical within tolerance" : "MISMATCH") << '\n';
+    return same ? 0 : 1;
+}
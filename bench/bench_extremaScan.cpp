@@ -0,0 +1,75 @@
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "benchUtils.hpp"
+#include "scaleSpaceBuilder.hpp"
+#include "keypointDetection.hpp"
+
+namespace {
+
+// The detector as it was before the row scan: one isLocalExtremaPerOctave call per interior pixel
+void perPixelDetection(const ss::ScaleSpace& DoG_scale_space, std::vector<kp::KeyPoint>& keypoints, float contrast_threshold) {
+    for (int octave_idx = 0; octave_idx < static_cast<int>(DoG_scale_space.size()); octave_idx++) {
+        for (int scale_idx = 1; scale_idx < static_cast<int>(DoG_scale_space[octave_idx].size()) - 1; scale_idx++) {
+            const cv::Mat& image = DoG_scale_space[octave_idx][scale_idx];
+            for (int row = 1; row < image.rows - 1; row++) {
+                for (int col = 1; col < image.cols - 1; col++) {
+                    if (kp::isLocalExtremaPerOctave(DoG_scale_space[octave_idx], scale_idx, row, col, contrast_threshold)) {
+                        keypoints.push_back({static_cast<float>(col * (1 << octave_idx)), static_cast<float>(row * (1 << octave_idx)),
+                                             static_cast<float>(scale_idx), octave_idx, image.at<float>(row, col)});
+                    }
+                }
+            }
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int rows = bench::argOr(argc, argv, 1, 1080);
+    const int cols = bench::argOr(argc, argv, 2, 1920);
+    const int iterations = bench::argOr(argc, argv, 3, 5);
+    const int scales_per_octave = 5;
+    const int num_octaves = static_cast<int>(std::log2(std::min(rows, cols))) - 3;
+    const float contrast_threshold = 0.04f;
+
+    cv::Mat image = bench::randomImage(rows, cols);
+    ss::ScaleSpaceBuilder builder(image.size(), num_octaves, scales_per_octave, 1.6f, false);
+    builder.build(image);
+    const ss::ScaleSpace& DoG = builder.DoGPyramid().scaleSpace();
+    std::cout << "Image " << cols << "x" << rows << ", " << num_octaves << " octaves, " << scales_per_octave << " scales\n\n";
+
+    std::vector<kp::KeyPoint> expected, keypoints;
+    double t_pixel = bench::timeMs([&] { expected.clear(); perPixelDetection(DoG, expected, contrast_threshold); }, iterations);
+    bench::report("per-pixel isLocalExtremaPerOctave", t_pixel);
+    double t_row = bench::timeMs([&] { keypoints.clear(); kp::coarseKeypointDetection(DoG, keypoints, contrast_threshold); }, iterations);
+    bench::report("row scan (coarseKeypointDetection)", t_row, t_pixel);
+
+    bool identical = keypoints.size() == expected.size();
+    for (size_t i = 0; identical && i < keypoints.size(); i++) {
+        identical = keypoints[i].x == expected[i].x && keypoints[i].y == expected[i].y && keypoints[i].scale_idx == expected[i].scale_idx &&
+                    keypoints[i].octave_idx == expected[i].octave_idx && keypoints[i].DoG_value == expected[i].DoG_value;
+    }
+    std::cout << "    " << keypoints.size() << " keypoints, " << (identical ? "identical" : "MISMATCH") << '\n';
+
+    std::cout << "\n-- band-parallel scan (cv::parallel_for_) --\n";
+    const int max_threads = cv::getNumThreads();
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        cv::setNumThreads(threads);
+        std::vector<kp::KeyPoint> parallel;
+        double t_parallel = bench::timeMs([&] {
+            parallel.clear();
+            kp::coarseKeypointDetection(DoG, parallel, contrast_threshold, exec::openCVExecutor());
+        }, iterations);
+        bench::report(std::to_string(threads) + " threads", t_parallel, t_row);
+        identical = identical && parallel.size() == keypoints.size();
+        for (size_t i = 0; identical && i < parallel.size(); i++) {
+            identical = parallel[i].x == keypoints[i].x && parallel[i].y == keypoints[i].y && parallel[i].scale_idx == keypoints[i].scale_idx &&
+                        parallel[i].octave_idx == keypoints[i].octave_idx && parallel[i].DoG_value == keypoints[i].DoG_value;
+        }
+    }
+    cv::setNumThreads(max_threads);
+    std::cout << "    " << (identical ? "identical to the serial scan" : "MISMATCH") << '\n';
+    return identical ? 0 : 1;
+}
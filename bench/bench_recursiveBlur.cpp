@@ -0,0 +1,108 @@
+#include <iostream>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "benchUtils.hpp"
+#include "blur.hpp"
+#include "scaleSpace.hpp"
+#include "dog.hpp"
+#include "keypointDetection.hpp"
+#include "refine.hpp"
+
+namespace {
+
+struct Extraction {
+    ss::ScaleSpace DoG;
+    std::vector<kp::KeyPoint> keypoints;
+};
+
+Extraction extract(const cv::Mat& image, int num_octaves, int scales_per_octave, float initial_scale, const ss::ScaleSpaceOptions& options) {
+    ss::ScaleSpace scale_space;
+    ss::prepareScaleSpace(scale_space, image, num_octaves, scales_per_octave, initial_scale, options);
+
+    Extraction result;
+    dog::calculateDifferenceOfGaussians(scale_space, result.DoG);
+
+    std::vector<kp::KeyPoint> candidates;
+    kp::coarseKeypointDetection(result.DoG, candidates, 0.04f);
+    for (kp::KeyPoint& keypoint : candidates) {
+        refine::refineKeypoints(result.DoG, keypoint);
+        if (keypoint.x != -1e6 && keypoint.y != -1e6) result.keypoints.push_back(keypoint);
+    }
+    return result;
+}
+
+// Fraction of reference keypoints with a candidate in the same octave within one octave pixel and half a scale step
+double repeatability(const std::vector<kp::KeyPoint>& reference, const std::vector<kp::KeyPoint>& candidates) {
+    if (reference.empty()) return 1.0;
+    int repeated = 0;
+    for (const kp::KeyPoint& a : reference) {
+        const float tolerance = static_cast<float>(1 << a.octave_idx);
+        for (const kp::KeyPoint& b : candidates) {
+            if (a.octave_idx == b.octave_idx && std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance &&
+                std::abs(a.scale_idx - b.scale_idx) < 0.5f) {
+                repeated++;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(repeated) / reference.size();
+}
+
+void reportAccuracy(const std::string& name, const Extraction& exact, const Extraction& approx) {
+    std::cout << name << '\n';
+    for (size_t octave = 0; octave < exact.DoG.size(); octave++) {
+        double max_error = 0.0, max_response = 0.0;
+        for (size_t level = 0; level < exact.DoG[octave].size(); level++) {
+            max_error = std::max(max_error, cv::norm(exact.DoG[octave][level], approx.DoG[octave][level], cv::NORM_INF));
+            max_response = std::max(max_response, cv::norm(exact.DoG[octave][level], cv::NORM_INF));
+        }
+        std::cout << "    octave " << octave << "  max |DoG error| " << max_error << "  (" << 100.0 * max_error / max_response
+                  << "% of max |DoG|)\n";
+    }
+    std::cout << "    keypoints " << exact.keypoints.size() << " -> " << approx.keypoints.size() << ", repeatability "
+              << 100.0 * repeatability(exact.keypoints, approx.keypoints) << "%\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int rows = bench::argOr(argc, argv, 1, 1080);
+    const int cols = bench::argOr(argc, argv, 2, 1920);
+    const int iterations = bench::argOr(argc, argv, 3, 5);
+    const int scales_per_octave = 5;
+    const float initial_scale = 1.6f;
+    const int num_octaves = static_cast<int>(std::log2(std::min(rows, cols))) - 3;
+
+    cv::Mat image = bench::randomImage(rows, cols);
+    std::cout << "Image " << cols << "x" << rows << ", " << num_octaves << " octaves, " << scales_per_octave << " scales\n\n";
+
+    std::cout << "-- single blur, max |diff| against cv::GaussianBlur --\n";
+    cv::Mat exact, out;
+    for (float sigma : {1.0f, 2.0f, 4.0f, 8.0f, 16.0f}) {
+        double t_cv = bench::timeMs([&] { blur::gaussianBlur(image, exact, sigma, blur::Backend::OpenCV); }, iterations);
+        std::string label = "sigma " + std::to_string(sigma);
+        bench::report(label + " opencv", t_cv);
+        bench::report(label + " separable", bench::timeMs([&] { blur::gaussianBlur(image, out, sigma, blur::Backend::Separable); }, iterations), t_cv);
+        bench::report(label + " recursive", bench::timeMs([&] { blur::gaussianBlur(image, out, sigma, blur::Backend::Recursive); }, iterations), t_cv);
+        std::cout << "    recursive max |diff| " << cv::norm(exact, out, cv::NORM_INF) << '\n';
+    }
+
+    std::cout << "\n-- accuracy against the exact (FIR only) scale space --\n";
+    for (ss::ConstructionMode mode : {ss::ConstructionMode::Incremental, ss::ConstructionMode::DirectFromBase}) {
+        const std::string mode_name = mode == ss::ConstructionMode::Incremental ? "incremental" : "direct";
+        ss::ScaleSpaceOptions options;
+        options.mode = mode;
+        options.recursive_sigma_cutoff = std::numeric_limits<float>::infinity();
+        Extraction reference = extract(image, num_octaves, scales_per_octave, initial_scale, options);
+
+        for (float cutoff : {0.0f, 2.0f, ss::ScaleSpaceOptions{}.recursive_sigma_cutoff}) {
+            options.recursive_sigma_cutoff = cutoff;
+            reportAccuracy(mode_name + ", recursive above sigma " + std::to_string(cutoff),
+                           reference, extract(image, num_octaves, scales_per_octave, initial_scale, options));
+        }
+    }
+
+    return 0;
+}
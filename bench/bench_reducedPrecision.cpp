@@ -0,0 +1,85 @@
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "benchUtils.hpp"
+#include "scaleSpace.hpp"
+#include "pyramid.hpp"
+#include "dog.hpp"
+#include "keypointDetection.hpp"
+#include "refine.hpp"
+
+namespace {
+
+std::vector<kp::KeyPoint> detectAndRefine(const ss::Pyramid& DoG_pyramid, float contrast_threshold) {
+    std::vector<kp::KeyPoint> candidates, keypoints;
+    kp::coarseKeypointDetection(DoG_pyramid, candidates, contrast_threshold);
+    for (kp::KeyPoint& keypoint : candidates) {
+        refine::refineKeypoints(DoG_pyramid, keypoint);
+        if (keypoint.x != -1e6 && keypoint.y != -1e6) keypoints.push_back(keypoint);
+    }
+    return keypoints;
+}
+
+// Fraction of reference keypoints with a candidate in the same octave within a tenth of an octave pixel
+double agreement(const std::vector<kp::KeyPoint>& reference, const std::vector<kp::KeyPoint>& candidates) {
+    if (reference.empty()) return 1.0;
+    int repeated = 0;
+    for (const kp::KeyPoint& a : reference) {
+        const float tolerance = 0.1f * (1 << a.octave_idx);
+        for (const kp::KeyPoint& b : candidates) {
+            if (a.octave_idx == b.octave_idx && std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance) {
+                repeated++;
+                break;
+            }
+        }
+    }
+    return static_cast<double>(repeated) / reference.size();
+}
+
+}
+
+int main(int argc, char** argv) {
+    const int rows = bench::argOr(argc, argv, 1, 2160);
+    const int cols = bench::argOr(argc, argv, 2, 3840);
+    const int iterations = bench::argOr(argc, argv, 3, 5);
+    const int scales_per_octave = 5;
+    const float initial_scale = 1.6f;
+    const float contrast_threshold = 0.04f;
+    const int num_octaves = static_cast<int>(std::log2(std::min(rows, cols))) - 3;
+
+    cv::Mat image = bench::randomImage(rows, cols);
+    std::cout << "Image " << cols << "x" << rows << ", " << num_octaves << " octaves, " << scales_per_octave << " scales\n\n";
+
+    ss::Pyramid gaussian, DoG, fixed_gaussian, fixed_DoG;
+    ss::ScaleSpaceOptions options;
+    ss::prepareScaleSpace(gaussian, image, num_octaves, scales_per_octave, initial_scale, options);
+    options.storage_depth = CV_16S;
+    ss::prepareScaleSpace(fixed_gaussian, image, num_octaves, scales_per_octave, initial_scale, options);
+
+    std::cout << "-- DoG subtraction --\n";
+    double t_float = bench::timeMs([&] { dog::calculateDifferenceOfGaussians(gaussian, DoG); }, iterations);
+    bench::report("float32", t_float);
+    bench::report("int16", bench::timeMs([&] { dog::calculateDifferenceOfGaussians(fixed_gaussian, fixed_DoG); }, iterations), t_float);
+    std::cout << "    Gaussian + DoG memory " << (gaussian.bytes() + DoG.bytes()) / (1 << 20) << " MiB -> "
+              << (fixed_gaussian.bytes() + fixed_DoG.bytes()) / (1 << 20) << " MiB\n";
+
+    std::cout << "\n-- coarse extremum scan --\n";
+    std::vector<kp::KeyPoint> candidates;
+    t_float = bench::timeMs([&] { candidates.clear(); kp::coarseKeypointDetection(DoG, candidates, contrast_threshold); }, iterations);
+    size_t float_candidates = candidates.size();
+    bench::report("float32", t_float);
+    bench::report("int16", bench::timeMs([&] {
+        candidates.clear();
+        kp::coarseKeypointDetection(fixed_DoG, candidates, contrast_threshold);
+    }, iterations), t_float);
+    std::cout << "    candidates " << float_candidates << " -> " << candidates.size() << '\n';
+
+    std::cout << "\n-- refined keypoint agreement with float32 --\n";
+    std::vector<kp::KeyPoint> reference = detectAndRefine(DoG, contrast_threshold);
+    std::vector<kp::KeyPoint> reduced = detectAndRefine(fixed_DoG, contrast_threshold);
+    std::cout << "    keypoints " << reference.size() << " -> " << reduced.size() << ", within 0.1 octave px "
+              << 100.0 * agreement(reference, reduced) << "%\n";
+    std::cout << "    value scale " << fixed_DoG.valueScale() << " (DoG step " << 1.0f / fixed_DoG.valueScale() << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "benchUtils.hpp"
+#include "scaleSpaceBuilder.hpp"
+#include "keypointDetection.hpp"
+#include "keypointSet.hpp"
+#include "refine.hpp"
+
+int main(int argc, char** argv) {
+    const int rows = bench::argOr(argc, argv, 1, 1080);
+    const int cols = bench::argOr(argc, argv, 2, 1920);
+    const int iterations = bench::argOr(argc, argv, 3, 5);
+    const int scales_per_octave = 5;
+    const int num_octaves = static_cast<int>(std::log2(std::min(rows, cols))) - 3;
+
+    cv::Mat image = bench::randomImage(rows, cols);
+    ss::ScaleSpaceBuilder builder(image.size(), num_octaves, scales_per_octave, 1.6f, false);
+    builder.build(image);
+    const ss::Pyramid& DoG = builder.DoGPyramid();
+
+    // A low threshold so there are enough candidates to time
+    std::vector<kp::KeyPoint> candidates;
+    kp::coarseKeypointDetection(DoG, candidates, 0.001f);
+    std::cout << "Image " << cols << "x" << rows << ", " << candidates.size() << " candidates\n\n";
+
+    kp::KeyPointSet scalar, batched;
+    double t_scalar = bench::timeMs([&] { scalar = kp::KeyPointSet(candidates); refine::refineKeypoints(DoG, scalar); }, iterations);
+    bench::report("refineKeypoints (stencil, one at a time)", t_scalar);
+    double t_batch = bench::timeMs([&] { batched = kp::KeyPointSet(candidates); refine::refineKeypointsBatch(DoG, batched); }, iterations);
+    bench::report("refineKeypointsBatch", t_batch, t_scalar);
+
+    bool same = scalar.size() == batched.size();
+    float max_diff = 0.0f;
+    for (size_t i = 0; same && i < scalar.size(); i++) {
+        same = scalar.octaveIdx()[i] == batched.octaveIdx()[i];
+        max_diff = std::max({max_diff, std::abs(scalar.x()[i] - batched.x()[i]), std::abs(scalar.y()[i] - batched.y()[i]),
+                             std::abs(scalar.scaleIdx()[i] - batched.scaleIdx()[i])});
+    }
+    std::cout << "    " << scalar.size() << " kept, " << (same ? "same keypoints" : "MISMATCH") << ", max |diff| " << max_diff << '\n';
+
+    std::cout << "\n-- iterative localization (max_iterations fits per candidate) --\n";
+    for (int max_iterations : {1, 2, 5}) {
+        refine::LocalizationOptions options;
+        options.max_iterations = max_iterations;
+        refine::LocalizationStats stats;
+        kp::KeyPointSet localized;
+        double t_localize = bench::timeMs([&] {
+            localized = kp::KeyPointSet(candidates);
+            refine::localizeKeypoints(DoG, localized, options, &stats);
+        }, iterations);
+        bench::report("localizeKeypoints, " + std::to_string(max_iterations) + " iterations", t_localize, t_scalar);
+        std::cout << "    " << localized.size() << " kept, " << stats.moves << " moves, " << stats.duplicates << " duplicates, "
+                  << stats.stencil_loads << " stencil loads, " << stats.cache_hits << " cache hits\n";
+    }
+    return same ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "benchUtils.hpp"
+#include "blur.hpp"
+#include "scaleSpace.hpp"
+#include "scaleSpaceBuilder.hpp"
+
+int main(int argc, char** argv) {
+    const int rows = bench::argOr(argc, argv, 1, 2160);
+    const int cols = bench::argOr(argc, argv, 2, 3840);
+    const int iterations = bench::argOr(argc, argv, 3, 5);
+    const int scales_per_octave = 5;
+    const float initial_scale = 1.6f;
+    const int num_octaves = static_cast<int>(std::log2(std::min(rows, cols))) - 3;
+
+    cv::Mat image = bench::randomImage(rows, cols);
+    std::cout << "Image " << cols << "x" << rows << ", " << num_octaves << " octaves, " << scales_per_octave << " scales\n\n";
+
+    // Per-level blur with the incremental sigmas used by prepareOctave
+    std::cout << "-- single blur --\n";
+    cv::Mat out_cv, out_sep;
+    for (int level = 1; level < scales_per_octave + 2; level++) {
+        float delta = ss::computeDeltaSigma(ss::computeSigmaForLevel(initial_scale, level - 1, scales_per_octave),
+                                            ss::computeSigmaForLevel(initial_scale, level, scales_per_octave));
+        double t_cv = bench::timeMs([&] { blur::gaussianBlur(image, out_cv, delta, blur::Backend::OpenCV); }, iterations);
+        double t_sep = bench::timeMs([&] { blur::gaussianBlur(image, out_sep, delta, blur::Backend::Separable); }, iterations);
+        std::string label = "sigma " + std::to_string(delta);
+        bench::report(label + " opencv", t_cv);
+        bench::report(label + " separable", t_sep, t_cv);
+        std::cout << "    max |diff| " << cv::norm(out_cv, out_sep, cv::NORM_INF) << '\n';
+    }
+
+    std::cout << "\n-- prepareScaleSpace --\n";
+    ss::ScaleSpace scale_space;
+    ss::ScaleSpaceOptions options;
+    double t_cv = bench::timeMs([&] {
+        ss::prepareScaleSpace(scale_space, image, num_octaves, scales_per_octave, initial_scale, options);
+    }, iterations);
+    bench::report("opencv backend", t_cv);
+
+    options.blur_backend = blur::Backend::Separable;
+    double t_sep = bench::timeMs([&] {
+        ss::prepareScaleSpace(scale_space, image, num_octaves, scales_per_octave, initial_scale, options);
+    }, iterations);
+    bench::report("separable backend", t_sep, t_cv);
+
+    std::cout << "\n-- direct-from-base construction (" << cv::getNumThreads() << " threads) --\n";
+    options.mode = ss::ConstructionMode::DirectFromBase;
+    options.blur_backend = blur::Backend::OpenCV;
+    bench::report("opencv backend", bench::timeMs([&] {
+        ss::prepareScaleSpace(scale_space, image, num_octaves, scales_per_octave, initial_scale, options);
+    }, iterations), t_cv);
+
+    options.blur_backend = blur::Backend::Separable;
+    bench::report("separable backend", bench::timeMs([&] {
+        ss::prepareScaleSpace(scale_space, image, num_octaves, scales_per_octave, initial_scale, options);
+    }, iterations), t_cv);
+
+    std::cout << "\n-- ScaleSpaceBuilder (Gaussian + DoG) --\n";
+    ss::ScaleSpaceBuilder full(image.size(), num_octaves, scales_per_octave, initial_scale, true);
+    ss::ScaleSpaceBuilder fused(image.size(), num_octaves, scales_per_octave, initial_scale, false);
+    double t_full = bench::timeMs([&] { full.build(image); }, iterations);
+    bench::report("full pyramid", t_full);
+    bench::report("fused, Gaussian not retained", bench::timeMs([&] { fused.build(image); }, iterations), t_full);
+    std::cout << "    memory " << full.bytes() / (1 << 20) << " MiB -> " << fused.bytes() / (1 << 20) << " MiB\n";
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace mem {
+
+  // std::allocator with a fixed over-alignment, so the data() of vectors used by SIMD loops starts on a
+  // cache-line boundary.
+  template <typename T, size_t Alignment = 64>
+  struct AlignedAllocator {
+      using value_type = T;
+
+      template <typename U>
+      struct rebind {
+          using other = AlignedAllocator<U, Alignment>;
+      };
+
+      AlignedAllocator() = default;
+      template <typename U>
+      AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+      T* allocate(size_t n) {
+          return static_cast<T*>(::operator new[](n * sizeof(T), std::align_val_t(Alignment)));
+      }
+
+      void deallocate(T* ptr, size_t) noexcept {
+          ::operator delete[](ptr, std::align_val_t(Alignment));
+      }
+
+      template <typename U>
+      bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+  };
+
+  template <typename T>
+  using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}
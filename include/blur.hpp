@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace blur {
+
+  enum class Backend {
+      OpenCV,     // cv::GaussianBlur with BORDER_REFLECT101
+      Separable,  // cached-kernel separable engine (AVX2 / NEON row and column passes)
+      Recursive   // Young-van Vliet IIR, cost per pixel independent of sigma; approximate, sigma >= 0.5
+  };
+
+  struct GaussianKernel {
+      float sigma;
+      int radius;
+      std::vector<float> weights;  // 2 * radius + 1 taps, normalized to sum to 1
+  };
+
+  GaussianKernel createGaussianKernel(float sigma);
+
+  constexpr float kKernelSigmaStep = 1.0f / 65536.0f;
+
+  // Kernels depend only on sigma, and the per-level sigmas only on (initial_scale, level, scalesPerOctave),
+  // so every octave and every frame of a given configuration hits the same cache entries. Sigma is rounded
+  // to a multiple of kKernelSigmaStep and the kernel built for the rounded value, so nearby float sigmas share
+  // an entry. The step is small enough that the rounding stays well below float blur error.
+  const GaussianKernel& getCachedKernel(float sigma);
+
+  void separableGaussianBlur(const cv::Mat& src, cv::Mat& dst, const GaussianKernel& kernel, std::vector<float>& row_buffer);
+  void separableGaussianBlur(const cv::Mat& src, cv::Mat& dst, const GaussianKernel& kernel);
+
+  // Also writes difference = dst - src, one row at a time while the blurred row is still in cache.
+  void separableGaussianBlurWithDifference(const cv::Mat& src, cv::Mat& dst, cv::Mat& difference, const GaussianKernel& kernel,
+                                           std::vector<float>& row_buffer);
+
+  // Below this the Young-van Vliet fit of q(sigma) is no longer valid.
+  constexpr float kMinRecursiveSigma = 0.5f;
+
+  struct RecursiveGaussianCoefficients {
+      float sigma;
+      float B;                       // input gain
+      std::array<float, 3> feedback; // b1 / b0, b2 / b0, b3 / b0
+      int margin;                    // reflected samples run through the filter on each side to settle it
+  };
+
+  RecursiveGaussianCoefficients createRecursiveCoefficients(float sigma);
+
+  // Causal then anti-causal third-order pass along rows, then along columns. Works in place. The column pass
+  // needs a scratch image of (rows + 2 * margin) x cols floats: the first form allocates it per call, the
+  // second reuses the caller's buffer (as separableGaussianBlur does with row_buffer).
+  void recursiveGaussianBlur(const cv::Mat& src, cv::Mat& dst, float sigma);
+  void recursiveGaussianBlur(const cv::Mat& src, cv::Mat& dst, float sigma, std::vector<float>& scratch);
+
+  void gaussianBlur(const cv::Mat& src, cv::Mat& dst, float sigma, Backend backend);
+
+}
@@ -2,7 +2,15 @@
 
 #include <vector>
 #include <complex>
+#include <cstdint>
 #include "scaleSpace.hpp"
+#include "pyramid.hpp"
+#include "keypointSet.hpp"
+#include "histogram.hpp"
+#include "siftConfig.hpp"
+#include "executor.hpp"
+#include "descriptorMatrix.hpp"
+#include "distance.hpp"
 
 namespace desc {
   
@@ -18,12 +26,60 @@ float dominant_orientation;
 };
 
 std::vector<float> flattenHist(const std::vector<std::vector<float>>& hist);
+// Direct O(N^2) evaluation; calculateRealFFT gives the same spectrum.
 std::vector<std::complex<float>> calculateDFT(const std::vector<float>& descriptor);
+
+// Spectrum of a real input from precomputed twiddle tables: a radix-2 real FFT for power-of-two lengths,
+// with 32, 64 and 128 compiled as fixed-size kernels, and a table-driven DFT for other lengths.
+// half_spectrum keeps the spectrumLength(n, true) = n / 2 + 1 coefficients that are not conjugates of others.
+int spectrumLength(int n, bool half_spectrum);
+void calculateRealFFT(const float* input, int n, std::complex<float>* output, bool half_spectrum = false);
+std::vector<std::complex<float>> calculateRealFFT(const std::vector<float>& input, bool half_spectrum = false);
 float findDominantOrientation(const std::vector<float>& histogram);
 void l2Normalize(std::vector<float>& desc);
 void l2Normalize(std::vector<std::complex<float>>& desc); 
-Desc createDescStruct(const std::vector<std::vector<float>> & histogram);
+// With half_spectrum the coefficients that stand for a conjugate pair are weighted by sqrt(2) before
+// normalization, so distances between half-spectrum descriptors equal those between full ones.
+Desc createDescStruct(const std::vector<std::vector<float>> & histogram, bool half_spectrum = false);
+// The same descriptor written straight into row of matrix (whose cols must match).
+void createDescRow(const std::vector<std::vector<float>>& histogram, bool half_spectrum, DescriptorMatrix& matrix, int row);
+
+// Histogram and descriptor of each keypoint, sampled from a view of the image with no copy.
+Desc describeKeypoint(ss::LevelView<const float> image, const kp::KeyPoint& keypoint, const cfg::SiftConfig& config = {});
+std::vector<Desc> describeKeypoints(ss::LevelView<const float> image, const kp::KeyPointSet& keypoints, const cfg::SiftConfig& config = {});
+
+// Histograms sampled from each keypoint's octave level (see hist::generateOctaveLogPolarHistogram), or with
+// HistogramSource::GradientMagnitude gradient histograms (hist::generateGradientHistograms, config.map_mode).
+std::vector<Desc> describeKeypoints(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPointSet& keypoints,
+                                    const cfg::SiftConfig& config = {});
+std::vector<Desc> describeKeypoints(const ss::Pyramid& gaussian_pyramid, const kp::KeyPointSet& keypoints,
+                                    const cfg::SiftConfig& config = {});
 float euclideanDistance(const std::vector<std::complex<float>>& a, const std::vector<std::complex<float>>& b);
+// Matching runs the ratio test on squared distances from the kernel of activeDistanceBackend(); only the
+// distance of an accepted match is square-rooted.
 std::vector<desc::Match> matchDescriptorSets(const std::vector<desc::Desc>& set1, const std::vector<desc::Desc>& set2, float ratio = 0.8f); 
 
+// Row i of a against row j of b. Both matrices need the same cols and layout.
+float squaredDistance(const DescriptorMatrix& a, int i, const DescriptorMatrix& b, int j);
+float euclideanDistance(const DescriptorMatrix& a, int i, const DescriptorMatrix& b, int j);
+std::vector<desc::Match> matchDescriptorSets(const DescriptorMatrix& set1, const DescriptorMatrix& set2, float ratio = 0.8f);
+
+// Octave in the top bits, then x and y of the octave grid bit-interleaved (Z-order, 16 bits each).
+uint64_t mortonKey(int octave_idx, int y, int x);
+
+// Number of keypoints a worker claims at a time in extractDescriptors.
+constexpr int kDescriptorChunk = 32;
+
+// Descriptors of every kept keypoint, as describeKeypoints on the same scale space, written directly into
+// row i for the i-th kept keypoint. Keypoints are visited in mortonKey order of their octave-level position so
+// neighbouring windows are described together; workers (one executor task each) claim chunks of
+// kDescriptorChunk from a shared counter until none are left. For gradient histograms the maps of the levels
+// config.map_mode precomputes are built first, one executor task per level, and shared by all workers.
+DescriptorMatrix extractDescriptors(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPointSet& keypoints,
+                                    const cfg::SiftConfig& config = {}, const exec::Executor& executor = {},
+                                    DescriptorLayout layout = DescriptorLayout::Interleaved);
+DescriptorMatrix extractDescriptors(const ss::Pyramid& gaussian_pyramid, const kp::KeyPointSet& keypoints,
+                                    const cfg::SiftConfig& config = {}, const exec::Executor& executor = {},
+                                    DescriptorLayout layout = DescriptorLayout::Interleaved);
+
 }
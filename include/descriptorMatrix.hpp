@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cstddef>
+#include "alignedAllocator.hpp"
+
+namespace desc {
+
+  struct Desc;
+
+  // Interleaved rows hold re0 im0 re1 im1 ...; Split rows hold all real parts, then all imaginary parts
+  // starting at splitOffset().
+  enum class DescriptorLayout { Interleaved, Split };
+
+  // Descriptors as one 64-byte aligned row-major float buffer. Every row (and in the Split layout every
+  // half row) starts on a 64-byte boundary, and the padding after a row's values is zero, so kernels may
+  // run over rowStride() floats without a remainder loop. Dominant orientations are a parallel array.
+  class DescriptorMatrix {
+    public:
+      static constexpr int kAlignmentFloats = 16;
+
+      DescriptorMatrix() = default;
+      // rows x cols complex coefficients, all zero.
+      DescriptorMatrix(int rows, int cols, DescriptorLayout layout = DescriptorLayout::Interleaved);
+      static DescriptorMatrix fromDescs(const std::vector<Desc>& descs, DescriptorLayout layout = DescriptorLayout::Interleaved);
+
+      int rows() const { return rows_; }
+      int cols() const { return cols_; }
+      DescriptorLayout layout() const { return layout_; }
+      int rowStride() const { return row_stride_; }
+      // Offset of the imaginary parts within a Split row.
+      int splitOffset() const { return row_stride_ / 2; }
+
+      float* row(int i) { return values_.data() + static_cast<size_t>(i) * row_stride_; }
+      const float* row(int i) const { return values_.data() + static_cast<size_t>(i) * row_stride_; }
+
+      std::complex<float> at(int i, int k) const;
+      void setRow(int i, const std::complex<float>* coefficients);
+
+      float* orientations() { return orientations_.data(); }
+      const float* orientations() const { return orientations_.data(); }
+
+      Desc toDesc(int i) const;
+      std::vector<Desc> toDescs() const;
+
+    private:
+      int rows_ = 0;
+      int cols_ = 0;
+      DescriptorLayout layout_ = DescriptorLayout::Interleaved;
+      int row_stride_ = 0;
+      mem::AlignedVector<float> values_;
+      mem::AlignedVector<float> orientations_;
+  };
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+namespace desc {
+
+  // Instruction sets a squared-distance kernel can be built for, slowest first.
+  enum class DistanceBackend { Scalar, SSE42, AVX2, AVX512 };
+
+  // Sum over k < n of (a[k] - b[k])^2. Any n works; vector kernels finish with a scalar tail.
+  using SquaredDistanceKernel = float (*)(const float* a, const float* b, int n);
+
+  // Whether this CPU (and this build) can run backend. Scalar is always supported.
+  bool distanceBackendSupported(DistanceBackend backend);
+  // Throws std::invalid_argument for a backend the CPU cannot run.
+  SquaredDistanceKernel squaredDistanceKernel(DistanceBackend backend);
+  std::string distanceBackendName(DistanceBackend backend);
+
+  // The widest supported backend, detected on first use and fixed for the rest of the process.
+  DistanceBackend activeDistanceBackend();
+  float squaredDistance(const float* a, const float* b, int n);
+
+}
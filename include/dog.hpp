@@ -3,11 +3,16 @@
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include "scaleSpace.hpp"
+#include "pyramid.hpp"
 
 namespace dog {
 
   void validateOctaveImages(const ss::Octave& octave);
   void calculateDifferenceOfGaussiansPerOctave(const ss::Octave& octave, ss::Octave& single_DoG_octave);
   void calculateDifferenceOfGaussians(const ss::ScaleSpace& scale_space, ss::ScaleSpace& DoG_scale_space);
+  void subtractLevels(ss::LevelView<const float> upper, ss::LevelView<const float> lower, ss::LevelView<float> difference);
+  void subtractLevels(ss::LevelView<const short> upper, ss::LevelView<const short> lower, ss::LevelView<short> difference);
+  // The DoG pyramid gets the depth and value scale of the Gaussian pyramid (CV_32F or CV_16S).
+  void calculateDifferenceOfGaussians(const ss::Pyramid& gaussian_pyramid, ss::Pyramid& DoG_pyramid);
 }
 
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <functional>
+
+namespace exec {
+
+  // Runs task(i) for every i in [0, num_tasks), possibly concurrently, and returns once all have finished.
+  // Callers that need a reproducible result must not depend on the order tasks run in.
+  using Executor = std::function<void(int num_tasks, const std::function<void(int)>& task)>;
+
+  // cv::parallel_for_, i.e. whatever backend and thread count OpenCV is configured with.
+  Executor openCVExecutor();
+
+  // Tasks in index order on the calling thread.
+  Executor serialExecutor();
+
+  // The given executor, or openCVExecutor() when it is empty.
+  const Executor& orDefault(const Executor& executor);
+
+}
@@ -2,7 +2,15 @@
 
 #include <vector>
 #include <utility> 
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <tuple>
 #include "keypointDetection.hpp"
+#include "pyramid.hpp"
+#include "keypointSet.hpp"
+#include "siftConfig.hpp"
+#include "executor.hpp"
 
 namespace hist {
   
@@ -12,8 +20,143 @@ std::pair<float, float> calculateAngleAndLogRadius(int dx, int dy, float max_rad
 
 float calculateGaussianWindowWeight(int dx, int dy, float sigma);
 
+// One offset of the sampling window with its flat bin (angle_bin * num_radius_bins + radius_bin) and
+// Gaussian weight. dx / dy follow the order of generateCircularMask.
+struct LogPolarSample {
+    int dx;
+    int dy;
+    int bin;
+    float weight;
+};
+
+struct LogPolarTable {
+    float sigma = 0.0f;
+    int num_angle_bins = 0;
+    int num_radius_bins = 0;
+    int radius = 0;                     // largest |dx| or |dy| in samples
+    std::vector<LogPolarSample> samples;
+};
+
+// Everything of a histogram that does not depend on the image, computed once for a sigma and bin shape.
+LogPolarTable buildLogPolarTable(float sigma, int num_angle_bins, int num_radius_bins);
+
+constexpr float kLogPolarSigmaStep = 1.0f / 32.0f;
+
+// Thread-safe cache of tables keyed on sigma rounded to a multiple of sigma_step and the bin shape.
+// Tables are never evicted except by clear(); pointers handed out stay valid after it.
+class LogPolarTableCache {
+  public:
+    explicit LogPolarTableCache(float sigma_step = kLogPolarSigmaStep);
+
+    std::shared_ptr<const LogPolarTable> get(float sigma, int num_angle_bins, int num_radius_bins);
+    size_t size() const;
+    void clear();
+
+  private:
+    using Key = std::tuple<long long, int, int>;
+
+    float sigma_step_;
+    mutable std::shared_mutex mutex_;
+    std::map<Key, std::shared_ptr<const LogPolarTable>> tables_;
+};
+
+LogPolarTableCache& defaultLogPolarTableCache();
+
+// Histograms read their table from defaultLogPolarTableCache(), so sigma is quantized to kLogPolarSigmaStep.
+// 8 angle x 4 radius bins run a kernel with the shape compiled in; other shapes take the runtime path.
 void generateLogPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint,
     int num_angle_bins, int num_radius_bins, std::vector<std::vector<float>>& histogram);
 
-}
+void generateLogPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint,
+    const cfg::SiftConfig& config, std::vector<std::vector<float>>& histogram);
+
+void generateLogPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint,
+    const LogPolarTable& table, std::vector<std::vector<float>>& histogram);
+
+// Same histograms read straight from a strided view (a cv::Mat through ss::viewOf, or a pyramid level),
+// with no copy of the image.
+void generateLogPolarHistogram(ss::LevelView<const float> image, const kp::KeyPoint& keypoint,
+    int num_angle_bins, int num_radius_bins, std::vector<std::vector<float>>& histogram);
+
+void generateLogPolarHistogram(ss::LevelView<const float> image, const kp::KeyPoint& keypoint,
+    const cfg::SiftConfig& config, std::vector<std::vector<float>>& histogram);
 
+void generateLogPolarHistogram(ss::LevelView<const float> image, const kp::KeyPoint& keypoint,
+    const LogPolarTable& table, std::vector<std::vector<float>>& histogram);
+
+// Where a keypoint's window sits in the scale space: the Gaussian level nearest its scale in its own octave,
+// the window sigma initial_scale * 2^(scale_idx / scales_per_octave), and the keypoint in that octave's
+// coordinates. Throws std::out_of_range for an octave outside the scale space.
+struct OctavePlacement {
+    int octave = 0;
+    int level = 0;
+    float sigma = 0.0f;
+    kp::KeyPoint local{};
+};
+
+OctavePlacement placeInOctave(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPoint& keypoint, const cfg::SiftConfig& config);
+
+// Samples the Gaussian level nearest the keypoint's scale in the keypoint's own octave, in that octave's
+// coordinates, with window sigma initial_scale * 2^(scale_idx / scales_per_octave). The window then has
+// the same size in samples at every octave, and the already blurred level avoids aliasing. Levels must be
+// CV_32F.
+void generateOctaveLogPolarHistogram(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPoint& keypoint,
+    const cfg::SiftConfig& config, std::vector<std::vector<float>>& histogram);
+void generateOctaveLogPolarHistogram(const ss::Pyramid& gaussian_pyramid, const kp::KeyPoint& keypoint,
+    const cfg::SiftConfig& config, std::vector<std::vector<float>>& histogram);
+
+// Gradient magnitude and orientation (degrees, [0, 360)) of every sample of a level, from central
+// differences with the border replicated. intensity is the level itself, not a copy.
+struct LevelMaps {
+    ss::LevelView<const float> intensity;
+    cv::Mat magnitude;
+    cv::Mat orientation;
+};
+
+void computeLevelMaps(ss::LevelView<const float> level, LevelMaps& maps);
+
+// Log-polar histogram of Gaussian-weighted gradient magnitude, placed as generateOctaveLogPolarHistogram,
+// and the dominant gradient orientation of the window (36 bins of 10 degrees).
+struct GradientHistogram {
+    std::vector<std::vector<float>> histogram;
+    float dominant_orientation = 0.0f;
+};
+
+using MapMode = cfg::MapMode;
+
+// Fraction of a level the keypoints' windows must cover, in total, before its maps are precomputed.
+constexpr float kPrecomputeCoverage = 1.0f;
+
+MapMode chooseMapMode(const std::vector<float>& window_sigmas, cv::Size level_size);
+
+// LevelMaps of every (octave, level) sampled by placements whose mode is Precomputed (under Automatic,
+// chooseMapMode of the windows placed on that level), built concurrently on executor. Levels left on demand
+// have no entry.
+using LevelMapSet = std::map<std::pair<int, int>, LevelMaps>;
+LevelMapSet precomputeLevelMaps(const ss::ScaleSpace& gaussian_scale_space, const std::vector<OctavePlacement>& placements,
+    MapMode mode, const exec::Executor& executor = {});
+
+// Gradient histogram of one placed keypoint, gathered from maps when given (the maps of placement's level)
+// and differentiated on demand otherwise.
+void generateGradientHistogram(const ss::ScaleSpace& gaussian_scale_space, const OctavePlacement& placement, const LevelMaps* maps,
+    const cfg::SiftConfig& config, GradientHistogram& histogram);
+
+// One histogram per kept keypoint, in order. Both modes give identical histograms and dominant orientations,
+// so Automatic does not make a keypoint's result depend on the other keypoints of its level. The maps of
+// every precomputed level are held until the call returns.
+void generateGradientHistograms(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPointSet& keypoints,
+    const cfg::SiftConfig& config, std::vector<GradientHistogram>& histograms, MapMode mode = MapMode::Automatic);
+void generateGradientHistograms(const ss::Pyramid& gaussian_pyramid, const kp::KeyPointSet& keypoints, const cfg::SiftConfig& config,
+    std::vector<GradientHistogram>& histograms, MapMode mode = MapMode::Automatic);
+
+// The gather behind generateLogPolarHistogram. Non-zero AngleBins / RadiusBins fix the shape at compile
+// time (the table's must match); <0, 0> uses the table's. Instantiated for <8, 4> and <0, 0>.
+template <int AngleBins, int RadiusBins>
+void logPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint, const LogPolarTable& table,
+    std::vector<std::vector<float>>& histogram);
+
+template <int AngleBins, int RadiusBins>
+void logPolarHistogram(ss::LevelView<const float> image, const kp::KeyPoint& keypoint, const LogPolarTable& table,
+    std::vector<std::vector<float>>& histogram);
+
+}
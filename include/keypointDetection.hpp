@@ -3,6 +3,8 @@
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include "scaleSpace.hpp"
+#include "pyramid.hpp"
+#include "executor.hpp"
 
 namespace kp {
   
@@ -16,7 +18,41 @@ namespace kp {
 
   bool isLocalExtremaPerOctave(const ss::Octave& DoG_octave, int scale_idx, int row, int col, float contrast_threshold);
 
+  // Appends the extrema of the middle level in coarseKeypointDetection order. The threshold is in stored
+  // units; DoG_value is the stored sample divided by value_scale. Instantiated for float and short, both with
+  // AVX2 / NEON lane paths (8 / 4 float or 16 / 8 int16 columns per step) and a scalar tail.
+  template <typename T>
+  void detectLevelExtrema(ss::LevelView<const T> below, ss::LevelView<const T> level, ss::LevelView<const T> above,
+                          int octave_idx, int scale_idx, float threshold, float value_scale, std::vector<KeyPoint>& keypoints);
+
+  // detectLevelExtrema restricted to rows [row_begin, row_end) of the level.
+  template <typename T>
+  void detectRowExtrema(ss::LevelView<const T> below, ss::LevelView<const T> level, ss::LevelView<const T> above, int row_begin,
+                        int row_end, int octave_idx, int scale_idx, float threshold, float value_scale, std::vector<KeyPoint>& keypoints);
+
+  // Rows [row_begin, row_end) of DoG level scale_idx of an octave: the unit of band-parallel detection.
+  struct DetectionBand {
+      int octave_idx;
+      int scale_idx;
+      int row_begin;
+      int row_end;
+  };
+
+  constexpr int kRowsPerBand = 32;
+
+  // Bands in the order the serial scan visits them, so concatenating their outputs reproduces it.
+  std::vector<DetectionBand> planDetectionBands(const ss::ScaleSpace& DoG_scale_space, int rows_per_band = kRowsPerBand);
+
   void coarseKeypointDetection(const ss::ScaleSpace& DoG_scale_space, std::vector<KeyPoint>& keypoints, float contrast_threshold);
+  void coarseKeypointDetection(const ss::Pyramid& DoG_pyramid, std::vector<KeyPoint>& keypoints, float contrast_threshold);
+
+  // Parallel versions: each (octave, scale, band of rows) is a task with its own output buffer, and the
+  // buffers are concatenated in the serial order, so the result is identical to the serial scan whatever
+  // the executor or thread count. An empty executor means cv::parallel_for_.
+  void coarseKeypointDetection(const ss::ScaleSpace& DoG_scale_space, std::vector<KeyPoint>& keypoints, float contrast_threshold,
+                               const exec::Executor& executor);
+  void coarseKeypointDetection(const ss::Pyramid& DoG_pyramid, std::vector<KeyPoint>& keypoints, float contrast_threshold,
+                               const exec::Executor& executor);
 
 }
 
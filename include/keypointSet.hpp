@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "alignedAllocator.hpp"
+#include "keypointDetection.hpp"
+
+namespace kp {
+
+  // Keypoints stored as one aligned array per field, so later stages can load x, y, ... for a batch of
+  // keypoints with vector loads. A keypoint is rejected by clearing its mask entry instead of writing a
+  // sentinel into x; compact() then drops the rejected ones in a single stable pass.
+  class KeyPointSet {
+    public:
+      KeyPointSet() = default;
+      explicit KeyPointSet(const std::vector<KeyPoint>& keypoints);
+
+      size_t size() const { return x_.size(); }
+      bool empty() const { return x_.empty(); }
+      void reserve(size_t capacity);
+      void clear();
+
+      void push_back(const KeyPoint& keypoint);
+      void append(const std::vector<KeyPoint>& keypoints);
+      // Appends the kept keypoints of other.
+      void append(const KeyPointSet& other);
+
+      KeyPoint operator[](size_t i) const { return {x_[i], y_[i], scale_idx_[i], octave_idx_[i], DoG_value_[i]}; }
+      void set(size_t i, const KeyPoint& keypoint);
+
+      float* x() { return x_.data(); }
+      float* y() { return y_.data(); }
+      float* scaleIdx() { return scale_idx_.data(); }
+      int* octaveIdx() { return octave_idx_.data(); }
+      float* DoGValue() { return DoG_value_.data(); }
+      const float* x() const { return x_.data(); }
+      const float* y() const { return y_.data(); }
+      const float* scaleIdx() const { return scale_idx_.data(); }
+      const int* octaveIdx() const { return octave_idx_.data(); }
+      const float* DoGValue() const { return DoG_value_.data(); }
+
+      // 1 for kept keypoints, 0 for rejected ones. Batched stages may write it directly.
+      uint8_t* mask() { return mask_.data(); }
+      const uint8_t* mask() const { return mask_.data(); }
+      bool isKept(size_t i) const { return mask_[i] != 0; }
+      void reject(size_t i) { mask_[i] = 0; }
+
+      // Removes the rejected keypoints, keeping the order of the rest; returns the new size.
+      size_t compact();
+
+      std::vector<KeyPoint> toVector() const;
+
+    private:
+      mem::AlignedVector<float> x_;
+      mem::AlignedVector<float> y_;
+      mem::AlignedVector<float> scale_idx_;
+      mem::AlignedVector<int> octave_idx_;
+      mem::AlignedVector<float> DoG_value_;
+      mem::AlignedVector<uint8_t> mask_;
+  };
+
+}
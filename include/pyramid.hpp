@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <type_traits>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "scaleSpace.hpp"
+
+namespace ss {
+
+  // Non-owning view of one pyramid level; stride is in elements.
+  template <typename T>
+  struct LevelView {
+      T* data = nullptr;
+      int rows = 0;
+      int cols = 0;
+      size_t stride = 0;
+
+      T* row(int r) const { return data + r * stride; }
+      T& at(int r, int c) const { return data[r * stride + c]; }
+      bool empty() const { return data == nullptr || rows == 0 || cols == 0; }
+
+      operator LevelView<const T>() const requires (!std::is_const_v<T>) { return {data, rows, cols, stride}; }
+
+      cv::Mat mat() const {
+          return cv::Mat(rows, cols, cv::DataType<std::remove_const_t<T>>::type,
+                         const_cast<std::remove_const_t<T>*>(data), stride * sizeof(T));
+      }
+  };
+
+  // View over an existing single-channel cv::Mat, no copy.
+  template <typename T = float>
+  LevelView<T> viewOf(const cv::Mat& mat) {
+      if (mat.depth() != cv::DataType<std::remove_const_t<T>>::depth || mat.channels() != 1) {
+          throw std::invalid_argument("Mat type does not match the view element type.");
+      }
+      return {reinterpret_cast<T*>(mat.data), mat.rows, mat.cols, mat.step / sizeof(T)};
+  }
+
+  // Largest stored magnitude for CV_16S pyramids. Half the int16 range, so the difference of two levels
+  // (a DoG sample) still fits without saturating.
+  constexpr float kFixedPointRange = 16383.0f;
+
+  // All octaves and levels of a Gaussian or DoG pyramid in one aligned allocation. Every row starts on a
+  // 64-byte boundary and octave o has the size cv::resize(..., 0.5, 0.5) gives after o halvings.
+  // CV_16S pyramids store round(value * valueScale()).
+  class Pyramid {
+    public:
+      static constexpr size_t kAlignment = 64;
+
+      Pyramid() = default;
+      Pyramid(cv::Size base_size, int numOctaves, int levelsPerOctave, int depth = CV_32F);
+
+      // No-op when the geometry is unchanged, so a pyramid can be refilled without reallocating.
+      void allocate(cv::Size base_size, int numOctaves, int levelsPerOctave, int depth = CV_32F);
+
+      bool empty() const { return num_octaves_ == 0; }
+      int numOctaves() const { return num_octaves_; }
+      int levelsPerOctave() const { return levels_per_octave_; }
+      int depth() const { return depth_; }
+      size_t bytes() const { return arena_bytes_; }
+      const void* arena() const { return arena_.get(); }
+      cv::Size octaveSize(int octave) const { return octave_sizes_[octave]; }
+      size_t octaveStride(int octave) const { return octave_strides_[octave]; }
+      float valueScale() const { return value_scale_; }
+      void setValueScale(float value_scale);
+
+      template <typename T = float>
+      LevelView<T> view(int octave, int level) {
+          checkDepth(cv::DataType<T>::depth);
+          return {reinterpret_cast<T*>(levelData(octave, level)), octave_sizes_[octave].height,
+                  octave_sizes_[octave].width, octave_strides_[octave]};
+      }
+
+      template <typename T = float>
+      LevelView<const T> view(int octave, int level) const {
+          checkDepth(cv::DataType<T>::depth);
+          return {reinterpret_cast<const T*>(levelData(octave, level)), octave_sizes_[octave].height,
+                  octave_sizes_[octave].width, octave_strides_[octave]};
+      }
+
+      // cv::Mat headers into the arena for existing callers; valid while the pyramid is alive and unchanged.
+      const cv::Mat& mat(int octave, int level) const { return headers_[octave][level]; }
+      const ScaleSpace& scaleSpace() const { return headers_; }
+      ScaleSpace& scaleSpace() { return headers_; }
+
+    private:
+      struct AlignedFree {
+          void operator()(unsigned char* ptr) const;
+      };
+
+      unsigned char* levelData(int octave, int level) const;
+      void checkDepth(int depth) const;
+
+      std::unique_ptr<unsigned char[], AlignedFree> arena_;
+      size_t arena_bytes_ = 0;
+      int depth_ = CV_32F;
+      float value_scale_ = 1.0f;
+      int num_octaves_ = 0;
+      int levels_per_octave_ = 0;
+      std::vector<cv::Size> octave_sizes_;
+      std::vector<size_t> octave_strides_;
+      std::vector<size_t> level_offsets_;  // bytes, indexed octave * levels_per_octave_ + level
+      ScaleSpace headers_;
+  };
+
+  void quantizeLevel(LevelView<const float> src, LevelView<short> dst, float value_scale);
+  void dequantizeLevel(LevelView<const short> src, LevelView<float> dst, float value_scale);
+
+  // With options.storage_depth == CV_16S the levels are computed in float one octave at a time and stored
+  // quantized, with valueScale() chosen so the largest base magnitude maps to kFixedPointRange.
+  void prepareScaleSpace(Pyramid& pyramid, const cv::Mat& base_image, int numOctaves, int scalesPerOctave, float initial_scale,
+                         const ScaleSpaceOptions& options = {});
+
+}
@@ -1,28 +1,113 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <functional>
 #include <opencv2/opencv.hpp>
 #include "scaleSpace.hpp"
+#include "pyramid.hpp"
 #include "keypointDetection.hpp"
+#include "keypointSet.hpp"
+#include "executor.hpp"
+#include "siftConfig.hpp"
 
 namespace refine {
 
+  using Vec3 = std::array<float, 3>;
+  using Mat3 = std::array<std::array<float, 3>, 3>;
+
+  // 3x3x3 DoG neighbourhood of a keypoint, indexed [ds + 1][dy + 1][dx + 1]. Samples outside the scale
+  // space read as 0.
+  using Stencil = std::array<std::array<std::array<float, 3>, 3>, 3>;
+
+  float determinant(const Mat3& m);
+  Mat3 adjugate(const Mat3& m);
+  // All zeros for a (near) singular matrix.
+  Mat3 inverse(const Mat3& m);
+
+  // Reads the neighbourhood once; gradient and Hessian are then pure arithmetic on the stencil.
+  Stencil loadStencil(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint, float value_scale = 1.0f);
+  Vec3 stencilGradient(const Stencil& stencil);
+  Mat3 stencilHessian(const Stencil& stencil);
+
+  bool isOnEdge(const Mat3& hessian, float edge_threshold);
+
+  // Heap-allocating forms of the above, kept for existing callers.
   float calculateDeterminant(std::vector<std::vector<float>>& Hessian);
 
   std::vector<std::vector<float>> calculateAdjugate(std::vector<std::vector<float>>& Hessian);
 
   std::vector<std::vector<float>> calculateInverse(std::vector<std::vector<float>>& Hessian);
 
-  float accessScaleSpace(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint);
+  // value_scale only applies to CV_16S levels, which hold round(value * value_scale) (see ss::Pyramid).
+  float accessScaleSpace(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint, float value_scale = 1.0f);
 
-  std::vector<float> calculateKeypointGradients(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint);
+  std::vector<float> calculateKeypointGradients(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint,
+                                                float value_scale = 1.0f);
 
-  std::vector<std::vector<float>> calculateKeypointHessian(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint);
+  std::vector<std::vector<float>> calculateKeypointHessian(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint,
+                                                           float value_scale = 1.0f);
 
   bool isOnEdge(const std::vector<std::vector<float>>& hessian, float edge_threshold);
 
-  void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoint);
+  // Offset limit, contrast and edge thresholds come from config.
+  void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoint, float value_scale = 1.0f,
+                       const cfg::SiftConfig& config = {});
+  void refineKeypoints(const ss::Pyramid& DoG_pyramid, kp::KeyPoint& keypoint, const cfg::SiftConfig& config = {});
+
+  // Refines every kept keypoint, masks out the rejected ones and compacts the set.
+  void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPointSet& keypoints, float value_scale = 1.0f,
+                       const cfg::SiftConfig& config = {});
+  void refineKeypoints(const ss::Pyramid& DoG_pyramid, kp::KeyPointSet& keypoints, const cfg::SiftConfig& config = {});
+
+  constexpr int kRefineBatchSize = 8;
+
+  // Same result as refineKeypoints(..., KeyPointSet&) up to float rounding: stencils are gathered for
+  // kRefineBatchSize keypoints at a time and the solve and rejection tests run in vector lanes.
+  void refineKeypointsBatch(const ss::ScaleSpace& DoG_scale_space, kp::KeyPointSet& keypoints, float value_scale = 1.0f,
+                            const cfg::SiftConfig& config = {});
+  void refineKeypointsBatch(const ss::Pyramid& DoG_pyramid, kp::KeyPointSet& keypoints, const cfg::SiftConfig& config = {});
+
+  // Detection and refinement fused per kp::DetectionBand: a band's candidates are refined as soon as it has
+  // been scanned, while their DoG neighbourhoods are still in cache, and only the survivors are kept. The
+  // output is in band order, which is the order (and result) of coarseKeypointDetection followed by
+  // refineKeypoints on a KeyPointSet. Bands run on the executor (cv::parallel_for_ when empty).
+  // config.contrast_threshold is used for both detection and refinement.
+  void detectAndRefine(const ss::ScaleSpace& DoG_scale_space, const cfg::SiftConfig& config, kp::KeyPointSet& keypoints,
+                       const exec::Executor& executor = {});
+  void detectAndRefine(const ss::Pyramid& DoG_pyramid, const cfg::SiftConfig& config, kp::KeyPointSet& keypoints,
+                       const exec::Executor& executor = {});
+  // Detection threshold only; refinement uses the default SiftConfig.
+  void detectAndRefine(const ss::ScaleSpace& DoG_scale_space, float contrast_threshold, kp::KeyPointSet& keypoints,
+                       const exec::Executor& executor = {});
+  void detectAndRefine(const ss::Pyramid& DoG_pyramid, float contrast_threshold, kp::KeyPointSet& keypoints,
+                       const exec::Executor& executor = {});
+
+  struct LocalizationOptions {
+      int max_iterations = 5;
+      float contrast_threshold = 0.04f;
+      float edge_threshold = 10.0f;
+      bool remove_duplicates = true;
+  };
+
+  LocalizationOptions localizationOptions(const cfg::SiftConfig& config);
+
+  struct LocalizationStats {
+      int stencil_loads = 0;
+      int cache_hits = 0;
+      int moves = 0;
+      int duplicates = 0;
+  };
+
+  // Lowe-style localization: when the fitted offset is 0.5 or more in a dimension the keypoint moves to
+  // that neighbouring sample and is fitted again, up to max_iterations fits, instead of being rejected.
+  // Contrast is tested on the interpolated value (stored in DoG_value) and edges on the curvature ratio.
+  // Stencils come from a small fixed cache, and candidates converging on the same sample are reduced to
+  // the first one. Rejected keypoints are compacted away.
+  void localizeKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPointSet& keypoints, const LocalizationOptions& options = {},
+                         float value_scale = 1.0f, LocalizationStats* stats = nullptr);
+  void localizeKeypoints(const ss::Pyramid& DoG_pyramid, kp::KeyPointSet& keypoints, const LocalizationOptions& options = {},
+                         LocalizationStats* stats = nullptr);
 
 }
 
@@ -2,16 +2,37 @@
 
 #include <vector>
 #include <opencv2/opencv.hpp>
+#include "blur.hpp"
 
 namespace ss {
   
   typedef std::vector<cv::Mat> Octave;
   typedef std::vector<Octave> ScaleSpace;
 
+  enum class ConstructionMode {
+      Incremental,     // each level blurred from the previous one, each octave seeded from the previous octave
+      DirectFromBase   // each level blurred from the octave base with its absolute sigma, levels run concurrently
+  };
+
+  struct ScaleSpaceOptions {
+      blur::Backend blur_backend = blur::Backend::OpenCV;
+      ConstructionMode mode = ConstructionMode::Incremental;
+      // Blurs with a larger sigma switch to blur::Backend::Recursive, whose cost does not grow with sigma.
+      // Infinity keeps every level on blur_backend.
+      float recursive_sigma_cutoff = 4.0f;
+      // Storage of Pyramid outputs: CV_32F, or CV_16S fixed point scaled by Pyramid::valueScale().
+      // Vector ScaleSpace outputs are always CV_32F.
+      int storage_depth = CV_32F;
+  };
+
+  blur::Backend selectBlurBackend(const ScaleSpaceOptions& options, float sigma);
+
   float computeSigmaForLevel(float base_sigma, int level, int scalesPerOctave);
   float computeDeltaSigma(float prev_sigma, float curr_sigma);
-  void prepareOctave(Octave& octave, cv::Mat base_image, float initial_scale, int scalesPerOctave);
-  void prepareScaleSpace(ScaleSpace& scaleSpace, const cv::Mat& base_image, int numOctaves, int scalesPerOctave, float initial_scale);
+  void prepareOctave(Octave& octave, cv::Mat base_image, float initial_scale, int scalesPerOctave,
+                     const ScaleSpaceOptions& options = {});
+  void prepareScaleSpace(ScaleSpace& scaleSpace, const cv::Mat& base_image, int numOctaves, int scalesPerOctave, float initial_scale,
+                         const ScaleSpaceOptions& options = {});
 
 }
 
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "blur.hpp"
+#include "pyramid.hpp"
+
+namespace ss {
+
+  void downsampleByTwo(LevelView<const float> src, LevelView<float> dst);
+
+  // Builds the Gaussian and DoG pyramids for a stream of equally sized frames. Everything is allocated in
+  // the constructor; build() only refills the pyramids in place and performs no heap allocation.
+  //
+  // Each DoG level is written in the same pass that blurs the Gaussian level above it. With
+  // keep_gaussian_pyramid = false the Gaussian levels only live in two ping-pong buffers (enough to blur
+  // the next level and to seed the next octave), gaussianPyramid() stays empty, and the pyramid memory
+  // is roughly the DoG pyramid alone. That mode is detection-only: histograms and descriptors
+  // (hist::generateOctaveLogPolarHistogram, desc::extractDescriptors) sample the Gaussian level at each
+  // keypoint's scale, which can be any level of any octave, so they need keep_gaussian_pyramid = true.
+  class ScaleSpaceBuilder {
+    public:
+      ScaleSpaceBuilder(cv::Size frame_size, int numOctaves, int scalesPerOctave, float initial_scale,
+                        bool keep_gaussian_pyramid = true);
+
+      void build(const cv::Mat& frame);
+
+      const Pyramid& gaussianPyramid() const { return gaussian_pyramid_; }
+      const Pyramid& DoGPyramid() const { return DoG_pyramid_; }
+      cv::Size frameSize() const { return frame_size_; }
+      int numOctaves() const { return num_octaves_; }
+      int scalesPerOctave() const { return scales_per_octave_; }
+      bool keepsGaussianPyramid() const { return keep_gaussian_pyramid_; }
+      size_t bytes() const { return gaussian_pyramid_.bytes() + DoG_pyramid_.bytes() + scratch_.bytes(); }
+
+    private:
+      cv::Mat& gaussianLevel(int octave, int level);
+
+      cv::Size frame_size_;
+      int num_octaves_;
+      int scales_per_octave_;
+      float initial_scale_;
+      bool keep_gaussian_pyramid_;
+      std::vector<const blur::GaussianKernel*> level_kernels_;  // kernel taking level i - 1 to level i
+      std::vector<float> row_buffer_;
+      Pyramid gaussian_pyramid_;
+      Pyramid DoG_pyramid_;
+      Pyramid scratch_;                                      // two frame-sized Gaussian levels when not keeping the pyramid
+      std::vector<std::array<cv::Mat, 2>> scratch_headers_;  // per octave, headers of the two buffers at that octave's size
+      std::vector<int> base_slot_;                           // scratch buffer holding level 0 of each octave
+  };
+
+}
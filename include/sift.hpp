@@ -1,18 +1,30 @@
 #pragma once
 
+#include "executor.hpp"
+#include "siftConfig.hpp"
+#include "blur.hpp"
 #include "scaleSpace.hpp"
+#include "pyramid.hpp"
+#include "scaleSpaceBuilder.hpp"
 #include "dog.hpp"
 #include "keypointDetection.hpp"
+#include "keypointSet.hpp"
+#include "streamingDetector.hpp"
 #include "refine.hpp"
+#include "tiledExtraction.hpp"
 #include "histogram.hpp"
 #include "descriptor.hpp"
 #include "visualization.hpp"
 
 namespace SIFT {
+    using namespace exec;
+    using namespace cfg;
+    using namespace blur;
     using namespace ss;
     using namespace dog;
     using namespace kp;
     using namespace refine;
+    using namespace tile;
     using namespace hist;
     using namespace desc;
     using namespace vis;
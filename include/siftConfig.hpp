@@ -0,0 +1,53 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include <opencv2/opencv.hpp>
+
+namespace cfg {
+
+  // What descriptor histograms sum over the log-polar window: Gaussian intensity, or gradient magnitude
+  // (hist::generateGradientHistograms), whose dominant gradient orientation then becomes the descriptor's.
+  enum class HistogramSource { Intensity, GradientMagnitude };
+
+  // OnDemand differentiates only the samples a window visits; Precomputed builds a level's gradient maps
+  // once and gathers from them; Automatic picks per level with hist::chooseMapMode.
+  enum class MapMode { OnDemand, Precomputed, Automatic };
+
+  // Every tunable of the pipeline in one place. Stages take it by const reference; defaults are the
+  // values that used to be hard-coded.
+  struct SiftConfig {
+      int num_octaves = 0;                // 0: log2(min(rows, cols)) - 3 for the input image
+      int scales_per_octave = 5;
+      float initial_scale = 1.6f;
+      float contrast_threshold = 0.04f;   // detection and refined-position contrast
+      float edge_threshold = 10.0f;       // principal curvature ratio r
+      float offset_limit = 1.0f;          // refinement rejects offsets of this size or more
+      int num_angle_bins = 8;
+      int num_radius_bins = 4;
+      bool half_spectrum = false;         // descriptors keep only the n / 2 + 1 non-redundant coefficients;
+                                          // distances are unchanged
+      HistogramSource histogram_source = HistogramSource::Intensity;
+      MapMode map_mode = MapMode::Automatic;  // gradient maps, for HistogramSource::GradientMagnitude
+
+      // Throws std::invalid_argument for non-positive counts or thresholds.
+      void validate() const;
+      int numOctavesFor(cv::Size image_size) const;
+  };
+
+  // Calls fn(std::integral_constant<int, V>{}) when value is one of the specialized values V, else
+  // fn(std::integral_constant<int, 0>{}), so kernels can be written once with a compile-time trip count
+  // and a runtime fallback.
+  template <int... Specialized, typename Fn>
+  decltype(auto) dispatchFixed(int value, Fn&& fn) {
+      if constexpr (sizeof...(Specialized) == 0) {
+          return fn(std::integral_constant<int, 0>{});
+      } else {
+          return [&]<int First, int... Rest>(std::integer_sequence<int, First, Rest...>) -> decltype(auto) {
+              if (value == First) return fn(std::integral_constant<int, First>{});
+              return dispatchFixed<Rest...>(value, std::forward<Fn>(fn));
+          }(std::integer_sequence<int, Specialized...>{});
+      }
+  }
+
+}
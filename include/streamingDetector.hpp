@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "blur.hpp"
+#include "pyramid.hpp"
+#include "keypointDetection.hpp"
+
+namespace kp {
+
+  // Coarse detection (optionally followed by refinement) without a DoG pyramid. Each DoG level is written
+  // into a 3-slot ring while the Gaussian level above it is blurred; as soon as levels s-1, s and s+1 are
+  // resident, level s is scanned (and its keypoints refined) and the oldest slot is reused. Octaves run one
+  // after another, so one ring of frame-sized buffers serves all of them: 3 DoG and 2 Gaussian levels
+  // instead of (S+1) + (S+2) per octave. Everything is allocated in the constructor.
+  //
+  // Output matches ScaleSpaceBuilder + coarseKeypointDetection (+ refineKeypoints) on the same frame.
+  class StreamingDetector {
+    public:
+      StreamingDetector(cv::Size frame_size, int numOctaves, int scalesPerOctave, float initial_scale, float contrast_threshold,
+                        bool refine_keypoints = false);
+
+      // Appends keypoints in coarseKeypointDetection order; rejected ones are dropped when refining.
+      void detect(const cv::Mat& frame, std::vector<KeyPoint>& keypoints);
+
+      cv::Size frameSize() const { return frame_size_; }
+      size_t bytes() const { return buffers_.bytes(); }
+
+    private:
+      cv::Mat& gaussianLevel(int octave, int level);
+      cv::Mat& DoGLevel(int octave, int level);
+      void scanLevel(int octave, int level, std::vector<KeyPoint>& keypoints);
+
+      cv::Size frame_size_;
+      int num_octaves_;
+      int scales_per_octave_;
+      float contrast_threshold_;
+      bool refine_keypoints_;
+      std::vector<const blur::GaussianKernel*> level_kernels_;  // kernel taking level i - 1 to level i
+      std::vector<float> row_buffer_;
+      ss::Pyramid buffers_;                                      // slots 0-1 Gaussian ping-pong, 2-4 DoG ring
+      std::vector<std::array<cv::Mat, 5>> headers_;              // per octave, headers of the slots at that octave's size
+      std::vector<int> base_slot_;                               // Gaussian slot holding level 0 of each octave
+      ss::ScaleSpace refine_window_;                             // DoG headers refinement sees: only the resident triple is set
+      std::vector<KeyPoint> level_keypoints_;
+  };
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include "keypointDetection.hpp"
+
+namespace tile {
+
+  struct TilingOptions {
+      int num_octaves = 4;
+      int scales_per_octave = 5;
+      float initial_scale = 1.6f;
+      float contrast_threshold = 0.04f;
+      size_t memory_budget_bytes = size_t(1) << 30;  // for all tiles in flight together
+      int max_parallel_tiles = 0;                    // 0 = cv::getNumThreads()
+  };
+
+  struct Tile {
+      cv::Rect core;    // pixels whose keypoints this tile reports
+      cv::Rect padded;  // core plus halo, clipped to the image; what the pipeline actually runs on
+  };
+
+  // Base-image pixels a tile needs around its core so that blur support, octave seeding, the 3x3x3 extremum
+  // neighbourhood and refinement never see the tile border. Rounded up to a multiple of 2^numOctaves so
+  // every octave of a tile samples the same grid as the full image.
+  int computeHalo(int numOctaves, int scalesPerOctave, float initial_scale);
+
+  // Peak working set of one tile: float copy of the padded input, DoG pyramid and two Gaussian scratch levels.
+  size_t estimateTileBytes(cv::Size padded_size, int numOctaves, int scalesPerOctave);
+
+  std::vector<Tile> planTiles(cv::Size image_size, int core_size, int halo);
+
+  // Fills tile (single channel, any depth) with the image pixels inside region. Lets the source stay on disk.
+  // extractKeypointsTiled calls it from up to max_parallel_tiles worker threads at once, for disjoint tiles, so
+  // it must be safe to call concurrently (e.g. each call opens its own file handle, or the reader locks).
+  using TileReader = std::function<void(const cv::Rect& region, cv::Mat& tile)>;
+
+  // Tiled equivalent of scale space -> DoG -> coarse detection -> refinement for images too large for a full
+  // float pyramid. Each tile is read and converted to CV_32F by the worker processing it. Each keypoint is reported only by the
+  // tile whose core contains its detection sample, which removes the duplicates from overlapping halos.
+  // Output is in tile order, base-image coordinates, rejected points dropped.
+  void extractKeypointsTiled(cv::Size image_size, const TileReader& reader, const TilingOptions& options,
+                             std::vector<kp::KeyPoint>& keypoints);
+  void extractKeypointsTiled(const cv::Mat& image, const TilingOptions& options, std::vector<kp::KeyPoint>& keypoints);
+
+}
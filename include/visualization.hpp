@@ -3,10 +3,16 @@
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include "keypointDetection.hpp"
+#include "keypointSet.hpp"
 
 namespace vis {
 void drawKeypoints(const cv::Mat& image, const std::vector<kp::KeyPoint>& keypoints, cv::Mat& output, const cv::Scalar& color, int line_thickness);
 
 void drawKeypointsLines(const cv::Mat& image1, const std::vector<kp::KeyPoint>& keypoints1, const cv::Mat& image2, const std::vector<kp::KeyPoint>& keypoints2, cv::Mat& output, const cv::Scalar& color, int line_thickness);
 
+// Set versions: rejected (masked) keypoints are not drawn, and a line needs both of its ends kept.
+void drawKeypoints(const cv::Mat& image, const kp::KeyPointSet& keypoints, cv::Mat& output, const cv::Scalar& color, int line_thickness);
+
+void drawKeypointsLines(const cv::Mat& image1, const kp::KeyPointSet& keypoints1, const cv::Mat& image2, const kp::KeyPointSet& keypoints2, cv::Mat& output, const cv::Scalar& color, int line_thickness);
+
 } 
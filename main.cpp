@@ -17,20 +17,6 @@ void showImage(cv::Mat image, const std::string& window_name = "Tower"){
   cv::waitKey(0);
 }
 
-std::vector<std::vector<float>> convertMatToVector(const cv::Mat& mat) {
-    if (mat.empty() || mat.type() != CV_32F) {
-        return {};
-    }
-
-    std::vector<std::vector<float>> vec2D(mat.rows, std::vector<float>(mat.cols));
-    for (int i = 0; i < mat.rows; ++i) {
-        for (int j = 0; j < mat.cols; ++j) {
-            vec2D[i][j] = mat.at<float>(i, j);
-        }
-    }
-    return vec2D;
-}
-
 int main() {
     // Step 1: Load image
     cv::Mat original_input_8U = cv::imread("../Tower.jpeg", cv::IMREAD_GRAYSCALE); 
@@ -43,54 +29,34 @@ int main() {
     original_input_8U.convertTo(input, CV_32F);
     std::cout<<"Image is Loaded."<<'\n';
 
-    int num_octaves = static_cast<int>(std::log2(std::min(input.rows, input.cols))) - 3;
-    int scales_per_octave = 5;
-    float initial_scale = 1.6;
+    SIFT::SiftConfig config;
+    config.validate();
+    int num_octaves = config.numOctavesFor(input.size());
 
     // Step 2: Build scale-space pyramid
     std::cout<<"Building Scale Space with Number of Octaves : "<<num_octaves<<'\n';
     SIFT::ScaleSpace scale_space;
-    SIFT::prepareScaleSpace(scale_space, input, num_octaves, scales_per_octave, initial_scale);
+    SIFT::prepareScaleSpace(scale_space, input, num_octaves, config.scales_per_octave, config.initial_scale);
 
     // Step 3: Compute Difference of Gaussian (DoG)
     std::cout<<"Building Difference of Gaussian Pyramid"<<'\n';
     SIFT::ScaleSpace DoG_pyramid;
     SIFT::calculateDifferenceOfGaussians(scale_space, DoG_pyramid);
 
-    // Step 4 : Coarse Keypoint Detection 
-    std::cout<<"Initiating Coarse Keypoint Detection"<<'\n';
-    std::vector<SIFT::KeyPoint> keypoints;
-    SIFT::coarseKeypointDetection(DoG_pyramid, keypoints, 0.04);
-
-    // Converting CV::Mat to standard vector 
-    std::vector<std::vector<float>> input_vec = convertMatToVector(input);
-
-    std::cout<<"Initial size of kepoints array : "<<keypoints.size()<<'\n';
-    std::vector<SIFT::KeyPoint> refined_and_valid_keypoints;
+    // Step 4 and 5: Coarse keypoint detection, each band refined (low contrast / edge responses removed)
+    // right after it is scanned; survivors come out in band order
+    std::cout<<"Initiating Keypoint Detection and Refinement"<<'\n';
+    SIFT::KeyPointSet refined_keypoints;
+    SIFT::detectAndRefine(DoG_pyramid, config, refined_keypoints);
 
-    for(auto& kp : keypoints){
-
-      // Step 5: Refine keypoints (remove low contrast / edge responses)
-      SIFT::refineKeypoints(DoG_pyramid, kp);
-
-      // Check if the keypoint is still valid after refinement
-      if (kp.x != -1e6 && kp.y != -1e6) { 
-
-          std::vector<std::vector<float>> histogram;
-          SIFT::generateLogPolarHistogram(input_vec, kp, 8, 4, histogram);
-
-          // Step 7: Compute descriptors
-          desc::Desc descriptor = desc::createDescStruct(histogram);
-
-          refined_and_valid_keypoints.push_back(kp);
-      }
-    }
+    // Step 6 and 7: Histograms sampled from each keypoint's own octave level, then descriptors
+    SIFT::DescriptorMatrix descriptors = SIFT::extractDescriptors(scale_space, refined_keypoints, config);
 
-    std::cout<<"Size of keypoints array after refinement : "<<refined_and_valid_keypoints.size()<<'\n';
+    std::cout<<"Size of keypoints array after refinement : "<<refined_keypoints.size()<<'\n';
 
-    // Step 8: Visualize keypoints - use the refined_and_valid_keypoints
+    // Step 8: Visualize keypoints
     cv::Mat output_image_with_keypoints;
-    SIFT::drawKeypoints(original_input_8U, refined_and_valid_keypoints, output_image_with_keypoints, cv::Scalar(0, 0, 255), 20); 
+    SIFT::drawKeypoints(original_input_8U, refined_keypoints, output_image_with_keypoints, cv::Scalar(0, 0, 255), 20); 
 
     showImage(output_image_with_keypoints, "Keypoints on Original Tower Image");
 
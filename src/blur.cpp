@@ -0,0 +1,318 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "blur.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__ARM_FEATURE_FMA)
+#include <arm_neon.h>
+#endif
+
+namespace blur {
+
+namespace {
+
+// Scalar tails round exactly like the vector bodies, so a pixel's value does not depend on which lane
+// or tail position it lands in (tiled extraction relies on this to reproduce full-image results).
+inline float multiplyAdd(float a, float b, float c) {
+#if (defined(__AVX2__) && defined(__FMA__)) || (defined(__ARM_NEON) && defined(__ARM_FEATURE_FMA))
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+// dst[x] = w * (a[x] + b[x]) + dst[x], or dst[x] = w * a[x] when b is null (centre tap)
+void accumulateRows(float* dst, const float* a, const float* b, float w, int cols, bool first) {
+    int x = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    const __m256 vw = _mm256_set1_ps(w);
+    for (; x <= cols - 8; x += 8) {
+        __m256 v = _mm256_loadu_ps(a + x);
+        if (b) v = _mm256_add_ps(v, _mm256_loadu_ps(b + x));
+        __m256 acc = first ? _mm256_setzero_ps() : _mm256_loadu_ps(dst + x);
+        _mm256_storeu_ps(dst + x, _mm256_fmadd_ps(vw, v, acc));
+    }
+#elif defined(__ARM_NEON) && defined(__ARM_FEATURE_FMA)
+    const float32x4_t vw = vdupq_n_f32(w);
+    for (; x <= cols - 4; x += 4) {
+        float32x4_t v = vld1q_f32(a + x);
+        if (b) v = vaddq_f32(v, vld1q_f32(b + x));
+        float32x4_t acc = first ? vdupq_n_f32(0.0f) : vld1q_f32(dst + x);
+        vst1q_f32(dst + x, vfmaq_f32(acc, vw, v));
+    }
+#endif
+    for (; x < cols; x++) {
+        float v = b ? a[x] + b[x] : a[x];
+        dst[x] = first ? w * v : multiplyAdd(w, v, dst[x]);
+    }
+}
+
+// dst[x] = sum_k weights[k] * padded[x + k], using the kernel symmetry to halve the multiplies
+void convolveRow(float* dst, const float* padded, const float* weights, int radius, int cols) {
+    const float* centre = padded + radius;
+    int x = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    for (; x <= cols - 8; x += 8) {
+        __m256 acc = _mm256_mul_ps(_mm256_set1_ps(weights[radius]), _mm256_loadu_ps(centre + x));
+        for (int j = 1; j <= radius; j++) {
+            __m256 pair = _mm256_add_ps(_mm256_loadu_ps(centre + x - j), _mm256_loadu_ps(centre + x + j));
+            acc = _mm256_fmadd_ps(_mm256_set1_ps(weights[radius + j]), pair, acc);
+        }
+        _mm256_storeu_ps(dst + x, acc);
+    }
+#elif defined(__ARM_NEON) && defined(__ARM_FEATURE_FMA)
+    for (; x <= cols - 4; x += 4) {
+        float32x4_t acc = vmulq_n_f32(vld1q_f32(centre + x), weights[radius]);
+        for (int j = 1; j <= radius; j++) {
+            float32x4_t pair = vaddq_f32(vld1q_f32(centre + x - j), vld1q_f32(centre + x + j));
+            acc = vfmaq_f32(acc, pair, vdupq_n_f32(weights[radius + j]));
+        }
+        vst1q_f32(dst + x, acc);
+    }
+#endif
+    for (; x < cols; x++) {
+        float acc = weights[radius] * centre[x];
+        for (int j = 1; j <= radius; j++) {
+            acc = multiplyAdd(weights[radius + j], centre[x - j] + centre[x + j], acc);
+        }
+        dst[x] = acc;
+    }
+}
+
+void separableBlurRows(const cv::Mat& src, cv::Mat& dst, cv::Mat* difference, const GaussianKernel& kernel, std::vector<float>& row_buffer) {
+    if (src.empty() || src.type() != CV_32F) {
+        throw std::invalid_argument("Separable blur input must be non-empty and of type CV_32F.");
+    }
+
+    dst.create(src.size(), CV_32F);
+    if (dst.data == src.data) {
+        throw std::invalid_argument("Separable blur cannot run in place.");
+    }
+    if (difference) {
+        difference->create(src.size(), CV_32F);
+    }
+
+    const int rows = src.rows;
+    const int cols = src.cols;
+    const int radius = kernel.radius;
+    const float* weights = kernel.weights.data();
+
+    // One padded row: [radius reflected | cols column-filtered | radius reflected]
+    if (row_buffer.size() < static_cast<size_t>(cols + 2 * radius)) {
+        row_buffer.resize(cols + 2 * radius);
+    }
+    float* padded = row_buffer.data();
+    float* filtered = padded + radius;
+
+    for (int row = 0; row < rows; row++) {
+        // Column pass for this output row
+        accumulateRows(filtered, src.ptr<float>(row), nullptr, weights[radius], cols, true);
+        for (int j = 1; j <= radius; j++) {
+            const float* above = src.ptr<float>(cv::borderInterpolate(row - j, rows, cv::BORDER_REFLECT_101));
+            const float* below = src.ptr<float>(cv::borderInterpolate(row + j, rows, cv::BORDER_REFLECT_101));
+            accumulateRows(filtered, above, below, weights[radius + j], cols, false);
+        }
+
+        for (int j = 1; j <= radius; j++) {
+            filtered[-j] = filtered[cv::borderInterpolate(-j, cols, cv::BORDER_REFLECT_101)];
+            filtered[cols - 1 + j] = filtered[cv::borderInterpolate(cols - 1 + j, cols, cv::BORDER_REFLECT_101)];
+        }
+
+        // Row pass straight into the destination
+        float* out = dst.ptr<float>(row);
+        convolveRow(out, padded, weights, radius, cols);
+
+        if (difference) {
+            const float* in = src.ptr<float>(row);
+            float* diff = difference->ptr<float>(row);
+            for (int col = 0; col < cols; col++) {
+                diff[col] = out[col] - in[col];
+            }
+        }
+    }
+}
+
+// In-place causal then anti-causal pass over one line, each started from its steady state for a constant
+// signal equal to the first sample it sees.
+void recursiveLine(float* line, int length, const RecursiveGaussianCoefficients& c) {
+    const float B = c.B, f1 = c.feedback[0], f2 = c.feedback[1], f3 = c.feedback[2];
+
+    float w1 = line[0], w2 = line[0], w3 = line[0];
+    for (int i = 0; i < length; i++) {
+        float w = B * line[i] + f1 * w1 + f2 * w2 + f3 * w3;
+        line[i] = w;
+        w3 = w2; w2 = w1; w1 = w;
+    }
+
+    float y1 = line[length - 1], y2 = y1, y3 = y1;
+    for (int i = length - 1; i >= 0; i--) {
+        float y = B * line[i] + f1 * y1 + f2 * y2 + f3 * y3;
+        line[i] = y;
+        y3 = y2; y2 = y1; y1 = y;
+    }
+}
+
+// out[x] = B * in[x] + f1 * s1[x] + f2 * s2[x] + f3 * s3[x]; plain loops so the compiler vectorizes across columns
+void recursiveRowStep(float* out, const float* in, const float* s1, const float* s2, const float* s3,
+                      const RecursiveGaussianCoefficients& c, int cols) {
+    const float B = c.B, f1 = c.feedback[0], f2 = c.feedback[1], f3 = c.feedback[2];
+    for (int x = 0; x < cols; x++) {
+        out[x] = B * in[x] + f1 * s1[x] + f2 * s2[x] + f3 * s3[x];
+    }
+}
+
+}  // namespace
+
+GaussianKernel createGaussianKernel(float sigma) {
+    if (sigma <= 0) {
+        throw std::invalid_argument("Gaussian kernel sigma must be greater than 0.");
+    }
+
+    // Same support as cv::GaussianBlur picks for CV_32F input with ksize = (0, 0)
+    int ksize = cvRound(sigma * 4 * 2 + 1) | 1;
+    int radius = ksize / 2;
+
+    std::vector<double> taps(ksize);
+    double sum = 0.0;
+    for (int i = 0; i < ksize; i++) {
+        double x = i - radius;
+        taps[i] = std::exp(-(x * x) / (2.0 * sigma * sigma));
+        sum += taps[i];
+    }
+
+    GaussianKernel kernel{sigma, radius, std::vector<float>(ksize)};
+    for (int i = 0; i < ksize; i++) {
+        kernel.weights[i] = static_cast<float>(taps[i] / sum);
+    }
+    return kernel;
+}
+
+const GaussianKernel& getCachedKernel(float sigma) {
+    static std::mutex cache_mutex;
+    static std::unordered_map<long long, std::unique_ptr<GaussianKernel>> cache;
+
+    const long long key = std::llround(sigma / kKernelSigmaStep);
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, std::make_unique<GaussianKernel>(createGaussianKernel(key * kKernelSigmaStep))).first;
+    }
+    return *it->second;
+}
+
+void separableGaussianBlur(const cv::Mat& src, cv::Mat& dst, const GaussianKernel& kernel, std::vector<float>& row_buffer) {
+    separableBlurRows(src, dst, nullptr, kernel, row_buffer);
+}
+
+void separableGaussianBlurWithDifference(const cv::Mat& src, cv::Mat& dst, cv::Mat& difference, const GaussianKernel& kernel,
+                                         std::vector<float>& row_buffer) {
+    separableBlurRows(src, dst, &difference, kernel, row_buffer);
+}
+
+void separableGaussianBlur(const cv::Mat& src, cv::Mat& dst, const GaussianKernel& kernel) {
+    thread_local std::vector<float> row_buffer;
+    separableGaussianBlur(src, dst, kernel, row_buffer);
+}
+
+// Young and van Vliet, "Recursive implementation of the Gaussian filter", Signal Processing 44 (1995).
+RecursiveGaussianCoefficients createRecursiveCoefficients(float sigma) {
+    if (sigma < kMinRecursiveSigma) {
+        throw std::invalid_argument("Recursive Gaussian sigma must be at least 0.5.");
+    }
+
+    double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330 : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+    double q2 = q * q, q3 = q2 * q;
+    double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+    double b1 = 2.44413 * q + 2.85619 * q2 + 1.26661 * q3;
+    double b2 = -(1.4281 * q2 + 1.26661 * q3);
+    double b3 = 0.422205 * q3;
+
+    RecursiveGaussianCoefficients coefficients;
+    coefficients.sigma = sigma;
+    coefficients.B = static_cast<float>(1.0 - (b1 + b2 + b3) / b0);
+    coefficients.feedback = {static_cast<float>(b1 / b0), static_cast<float>(b2 / b0), static_cast<float>(b3 / b0)};
+    coefficients.margin = cvCeil(4 * sigma);
+    return coefficients;
+}
+
+void recursiveGaussianBlur(const cv::Mat& src, cv::Mat& dst, float sigma, std::vector<float>& scratch) {
+    if (src.empty() || src.type() != CV_32F) {
+        throw std::invalid_argument("Recursive blur input must be non-empty and of type CV_32F.");
+    }
+
+    const RecursiveGaussianCoefficients c = createRecursiveCoefficients(sigma);
+    const int rows = src.rows;
+    const int cols = src.cols;
+    const int margin = c.margin;
+
+    dst.create(src.size(), CV_32F);
+
+    // scratch holds one padded line, the padded column buffer and one steady-state row
+    const int padded_rows = rows + 2 * margin;
+    scratch.resize(static_cast<size_t>(cols + 2 * margin) + static_cast<size_t>(padded_rows) * cols + cols);
+    float* line = scratch.data();
+    float* causal = line + cols + 2 * margin;
+    float* steady = causal + static_cast<size_t>(padded_rows) * cols;
+
+    // Rows: each line is extended by reflection so the filter has settled before the first real sample
+    for (int row = 0; row < rows; row++) {
+        const float* in = src.ptr<float>(row);
+        for (int i = 0; i < cols + 2 * margin; i++) {
+            line[i] = in[cv::borderInterpolate(i - margin, cols, cv::BORDER_REFLECT_101)];
+        }
+        recursiveLine(line, cols + 2 * margin, c);
+        std::copy(line + margin, line + margin + cols, dst.ptr<float>(row));
+    }
+
+    // Columns: whole rows at a time. The causal pass fills `causal` (padded rows), the anti-causal pass
+    // overwrites it in place, reading its three already-finished successors.
+    auto padded = [&](int p) { return causal + static_cast<size_t>(p) * cols; };
+
+    const float* first = dst.ptr<float>(cv::borderInterpolate(-margin, rows, cv::BORDER_REFLECT_101));
+    for (int p = 0; p < padded_rows; p++) {
+        const float* in = dst.ptr<float>(cv::borderInterpolate(p - margin, rows, cv::BORDER_REFLECT_101));
+        recursiveRowStep(padded(p), in, p >= 1 ? padded(p - 1) : first, p >= 2 ? padded(p - 2) : first,
+                         p >= 3 ? padded(p - 3) : first, c, cols);
+    }
+
+    std::copy(padded(padded_rows - 1), padded(padded_rows - 1) + cols, steady);
+    for (int p = padded_rows - 1; p >= 0; p--) {
+        float* out = padded(p);
+        recursiveRowStep(out, out, p + 1 < padded_rows ? padded(p + 1) : steady,
+                         p + 2 < padded_rows ? padded(p + 2) : steady,
+                         p + 3 < padded_rows ? padded(p + 3) : steady, c, cols);
+        if (p >= margin && p < margin + rows) {
+            std::copy(out, out + cols, dst.ptr<float>(p - margin));
+        }
+    }
+}
+
+void recursiveGaussianBlur(const cv::Mat& src, cv::Mat& dst, float sigma) {
+    std::vector<float> scratch;
+    recursiveGaussianBlur(src, dst, sigma, scratch);
+}
+
+void gaussianBlur(const cv::Mat& src, cv::Mat& dst, float sigma, Backend backend) {
+    switch (backend) {
+        case Backend::Recursive:
+            recursiveGaussianBlur(src, dst, sigma);
+            break;
+        case Backend::Separable:
+            separableGaussianBlur(src, dst, getCachedKernel(sigma));
+            break;
+        case Backend::OpenCV:
+        default:
+            cv::GaussianBlur(src, dst, cv::Size(0, 0), sigma, sigma, cv::BORDER_REFLECT101);
+            break;
+    }
+}
+
+}
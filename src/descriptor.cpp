@@ -5,10 +5,24 @@
 #include <numeric>
 #include <algorithm>
 #include <limits>
+#include <cmath>
+#include <stdexcept>
 #include "descriptor.hpp"
+#include "distance.hpp"
 
 namespace desc {
 
+namespace {
+
+// Coefficients 1 .. (n - 1) / 2 of a half spectrum stand for themselves and their conjugates, so they are
+// scaled by sqrt(2). Norms and distances then equal those of the full spectrum (Parseval), and half and full
+// descriptors rank matches identically.
+void weightHalfSpectrum(std::complex<float>* spectrum, int n) {
+    const float weight = std::numbers::sqrt2_v<float>;
+    for (int k = 1; 2 * k < n; ++k) spectrum[k] *= weight;
+}
+
+}
 
 std::vector<float> flattenHist(const std::vector<std::vector<float>>& hist) {
     std::vector<float> descriptor;
@@ -60,37 +74,115 @@ void l2Normalize(std::vector<std::complex<float>>& desc) {
 }
 
 
-Desc createDescStruct(const std::vector<std::vector<float>>& histogram) {
+Desc createDescStruct(const std::vector<std::vector<float>>& histogram, bool half_spectrum) {
     std::vector<float> descriptor = flattenHist(histogram);
     float dominant_orientation = findDominantOrientation(descriptor);
     l2Normalize(descriptor);
-    std::vector<std::complex<float>> DFT_descriptor = calculateDFT(descriptor);
+    std::vector<std::complex<float>> DFT_descriptor = calculateRealFFT(descriptor, half_spectrum);
+    if (half_spectrum) weightHalfSpectrum(DFT_descriptor.data(), static_cast<int>(descriptor.size()));
     l2Normalize(DFT_descriptor);
 
     return Desc{DFT_descriptor, dominant_orientation};
 }
 
+void createDescRow(const std::vector<std::vector<float>>& histogram, bool half_spectrum, DescriptorMatrix& matrix, int row) {
+    // Same steps as createDescStruct, on per-thread scratch buffers
+    thread_local std::vector<float> descriptor;
+    thread_local std::vector<std::complex<float>> DFT_descriptor;
+    descriptor.clear();
+    for (const auto& angle_bin : histogram) {
+        descriptor.insert(descriptor.end(), angle_bin.begin(), angle_bin.end());
+    }
+    if (spectrumLength(static_cast<int>(descriptor.size()), half_spectrum) != matrix.cols()) {
+        throw std::invalid_argument("Histogram size does not match the descriptor matrix.");
+    }
 
-float euclideanDistance(const std::vector<std::complex<float>>& a, const std::vector<std::complex<float>>& b) {
-    float sum = 0.0f;
-    for (size_t i = 0; i < a.size(); ++i) {
-        std::complex<float> diff = a[i] - b[i];
-        sum += std::norm(diff);  
+    matrix.orientations()[row] = findDominantOrientation(descriptor);
+    l2Normalize(descriptor);
+    DFT_descriptor.resize(matrix.cols());
+    calculateRealFFT(descriptor.data(), static_cast<int>(descriptor.size()), DFT_descriptor.data(), half_spectrum);
+    if (half_spectrum) weightHalfSpectrum(DFT_descriptor.data(), static_cast<int>(descriptor.size()));
+    l2Normalize(DFT_descriptor);
+    matrix.setRow(row, DFT_descriptor.data());
+}
+
+Desc describeKeypoint(ss::LevelView<const float> image, const kp::KeyPoint& keypoint, const cfg::SiftConfig& config) {
+    std::vector<std::vector<float>> histogram;
+    hist::generateLogPolarHistogram(image, keypoint, config, histogram);
+    return createDescStruct(histogram, config.half_spectrum);
+}
+
+std::vector<Desc> describeKeypoints(ss::LevelView<const float> image, const kp::KeyPointSet& keypoints, const cfg::SiftConfig& config) {
+    std::vector<Desc> descriptors;
+    descriptors.reserve(keypoints.size());
+    std::vector<std::vector<float>> histogram;
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+        if (!keypoints.isKept(i)) continue;
+        hist::generateLogPolarHistogram(image, keypoints[i], config, histogram);
+        descriptors.push_back(createDescStruct(histogram, config.half_spectrum));
     }
-    return std::sqrt(sum);
+    return descriptors;
 }
 
+std::vector<Desc> describeKeypoints(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPointSet& keypoints,
+                                    const cfg::SiftConfig& config) {
+    if (config.histogram_source == cfg::HistogramSource::GradientMagnitude) {
+        std::vector<hist::GradientHistogram> histograms;
+        hist::generateGradientHistograms(gaussian_scale_space, keypoints, config, histograms, config.map_mode);
+        std::vector<Desc> descriptors;
+        descriptors.reserve(histograms.size());
+        for (const hist::GradientHistogram& histogram : histograms) {
+            descriptors.push_back(createDescStruct(histogram.histogram, config.half_spectrum));
+            descriptors.back().dominant_orientation = histogram.dominant_orientation;
+        }
+        return descriptors;
+    }
+
+    std::vector<Desc> descriptors;
+    descriptors.reserve(keypoints.size());
+    std::vector<std::vector<float>> histogram;
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+        if (!keypoints.isKept(i)) continue;
+        hist::generateOctaveLogPolarHistogram(gaussian_scale_space, keypoints[i], config, histogram);
+        descriptors.push_back(createDescStruct(histogram, config.half_spectrum));
+    }
+    return descriptors;
+}
 
-std::vector<Match> matchDescriptorSets(const std::vector<Desc>& set1, const std::vector<Desc>& set2, float ratio) {
+std::vector<Desc> describeKeypoints(const ss::Pyramid& gaussian_pyramid, const kp::KeyPointSet& keypoints, const cfg::SiftConfig& config) {
+    return describeKeypoints(gaussian_pyramid.scaleSpace(), keypoints, config);
+}
+
+
+float euclideanDistance(const std::vector<std::complex<float>>& a, const std::vector<std::complex<float>>& b) {
+    // std::complex<float> is laid out as two floats, so the coefficients are 2 * size() floats
+    return std::sqrt(squaredDistance(reinterpret_cast<const float*>(a.data()), reinterpret_cast<const float*>(b.data()),
+                                     2 * static_cast<int>(a.size())));
+}
+
+
+namespace {
+
+void checkComparable(const DescriptorMatrix& a, const DescriptorMatrix& b) {
+    if (a.cols() != b.cols() || a.layout() != b.layout()) {
+        throw std::invalid_argument("Descriptor matrices must have the same length and layout.");
+    }
+}
+
+// Ratio test on squared distances: best < ratio * second  <=>  best^2 < ratio^2 * second^2.
+// Only accepted matches pay for a sqrt.
+template <typename RowFn>
+std::vector<Match> ratioTestMatches(int rows1, int rows2, float ratio, RowFn&& squared_distance) {
     std::vector<Match> matches;
+    const float ratio_sq = ratio * ratio;
 
-    for (size_t i = 0; i < set1.size(); ++i) {
+    for (int i = 0; i < rows1; ++i) {
         float best_dist = std::numeric_limits<float>::max();
         float second_best_dist = std::numeric_limits<float>::max();
         int best_j = -1;
 
-        for (size_t j = 0; j < set2.size(); ++j) {
-            float dist = euclideanDistance(set1[i].descriptor, set2[j].descriptor);
+        for (int j = 0; j < rows2; ++j) {
+            float dist = squared_distance(i, j);
 
             if (dist < best_dist) {
                 second_best_dist = best_dist;
@@ -101,12 +193,42 @@ std::vector<Match> matchDescriptorSets(const std::vector<Desc>& set1, const std:
             }
         }
 
-        if (best_j != -1 && best_dist < ratio * second_best_dist) {
-            matches.push_back({static_cast<int>(i), best_j, best_dist});
+        if (best_j != -1 && best_dist < ratio_sq * second_best_dist) {
+            matches.push_back({i, best_j, std::sqrt(best_dist)});
         }
     }
 
     return matches;
 }
 
+}
+
+std::vector<Match> matchDescriptorSets(const std::vector<Desc>& set1, const std::vector<Desc>& set2, float ratio) {
+    const SquaredDistanceKernel kernel = squaredDistanceKernel(activeDistanceBackend());
+    return ratioTestMatches(static_cast<int>(set1.size()), static_cast<int>(set2.size()), ratio, [&](int i, int j) {
+        const auto& a = set1[i].descriptor;
+        return kernel(reinterpret_cast<const float*>(a.data()), reinterpret_cast<const float*>(set2[j].descriptor.data()),
+                      2 * static_cast<int>(a.size()));
+    });
+}
+
+float squaredDistance(const DescriptorMatrix& a, int i, const DescriptorMatrix& b, int j) {
+    checkComparable(a, b);
+    // Padding is zero in both rows, so the whole stride can be summed
+    return squaredDistance(a.row(i), b.row(j), a.rowStride());
+}
+
+float euclideanDistance(const DescriptorMatrix& a, int i, const DescriptorMatrix& b, int j) {
+    return std::sqrt(squaredDistance(a, i, b, j));
+}
+
+std::vector<Match> matchDescriptorSets(const DescriptorMatrix& set1, const DescriptorMatrix& set2, float ratio) {
+    checkComparable(set1, set2);
+    const SquaredDistanceKernel kernel = squaredDistanceKernel(activeDistanceBackend());
+    const int stride = set1.rowStride();
+    return ratioTestMatches(set1.rows(), set2.rows(), ratio, [&](int i, int j) {
+        return kernel(set1.row(i), set2.row(j), stride);
+    });
+}
+
 }  // namespace desc
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "descriptor.hpp"
+
+namespace desc {
+
+namespace {
+
+// Spreads the low 16 bits of v to the even bit positions
+uint64_t spreadBits(uint32_t v) {
+    uint64_t x = v & 0xFFFF;
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+}
+
+uint64_t mortonKey(int octave_idx, int y, int x) {
+    const uint32_t clamped_y = static_cast<uint32_t>(std::clamp(y, 0, 0xFFFF));
+    const uint32_t clamped_x = static_cast<uint32_t>(std::clamp(x, 0, 0xFFFF));
+    return (static_cast<uint64_t>(octave_idx) << 32) | (spreadBits(clamped_y) << 1) | spreadBits(clamped_x);
+}
+
+DescriptorMatrix extractDescriptors(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPointSet& keypoints,
+                                    const cfg::SiftConfig& config, const exec::Executor& executor, DescriptorLayout layout) {
+    config.validate();
+
+    std::vector<size_t> kept;
+    kept.reserve(keypoints.size());
+    for (size_t i = 0; i < keypoints.size(); i++) {
+        if (keypoints.isKept(i)) kept.push_back(i);
+    }
+
+    DescriptorMatrix matrix(static_cast<int>(kept.size()), spectrumLength(config.num_angle_bins * config.num_radius_bins, config.half_spectrum),
+                            layout);
+    if (kept.empty()) return matrix;
+
+    std::vector<hist::OctavePlacement> placements(kept.size());
+    for (size_t row = 0; row < kept.size(); row++) {
+        placements[row] = hist::placeInOctave(gaussian_scale_space, keypoints[kept[row]], config);
+    }
+
+    // Z-order of the position each window is sampled at
+    std::vector<std::pair<uint64_t, int>> order(kept.size());
+    for (size_t row = 0; row < kept.size(); row++) {
+        const hist::OctavePlacement& placement = placements[row];
+        order[row] = {mortonKey(placement.octave, static_cast<int>(std::round(placement.local.y)), static_cast<int>(std::round(placement.local.x))),
+                      static_cast<int>(row)};
+    }
+    std::sort(order.begin(), order.end());
+
+    // Gradient maps are built up front, one executor task per level, and only read by the workers
+    const bool gradient = config.histogram_source == cfg::HistogramSource::GradientMagnitude;
+    hist::LevelMapSet maps;
+    if (gradient) maps = hist::precomputeLevelMaps(gaussian_scale_space, placements, config.map_mode, executor);
+
+    const int num_chunks = (matrix.rows() + kDescriptorChunk - 1) / kDescriptorChunk;
+    const int num_workers = std::min(num_chunks, std::max(1, cv::getNumThreads()));
+    std::atomic<int> next_chunk{0};
+
+    exec::orDefault(executor)(num_workers, [&](int) {
+        std::vector<std::vector<float>> histogram;
+        hist::GradientHistogram gradient_histogram;
+        for (int chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++) {
+            const int end = std::min(matrix.rows(), (chunk + 1) * kDescriptorChunk);
+            for (int k = chunk * kDescriptorChunk; k < end; k++) {
+                const int row = order[k].second;
+                const hist::OctavePlacement& placement = placements[row];
+                if (gradient) {
+                    const auto it = maps.find({placement.octave, placement.level});
+                    hist::generateGradientHistogram(gaussian_scale_space, placement, it == maps.end() ? nullptr : &it->second, config,
+                                                    gradient_histogram);
+                    createDescRow(gradient_histogram.histogram, config.half_spectrum, matrix, row);
+                    matrix.orientations()[row] = gradient_histogram.dominant_orientation;
+                } else {
+                    const auto table = hist::defaultLogPolarTableCache().get(placement.sigma, config.num_angle_bins, config.num_radius_bins);
+                    hist::generateLogPolarHistogram(ss::viewOf<const float>(gaussian_scale_space[placement.octave][placement.level]),
+                                                    placement.local, *table, histogram);
+                    createDescRow(histogram, config.half_spectrum, matrix, row);
+                }
+            }
+        }
+    });
+
+    return matrix;
+}
+
+DescriptorMatrix extractDescriptors(const ss::Pyramid& gaussian_pyramid, const kp::KeyPointSet& keypoints, const cfg::SiftConfig& config,
+                                    const exec::Executor& executor, DescriptorLayout layout) {
+    return extractDescriptors(gaussian_pyramid.scaleSpace(), keypoints, config, executor, layout);
+}
+
+}
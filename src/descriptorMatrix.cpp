@@ -0,0 +1,70 @@
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <stdexcept>
+#include "descriptorMatrix.hpp"
+#include "descriptor.hpp"
+
+namespace desc {
+
+namespace {
+
+int roundUp(int n, int multiple) { return (n + multiple - 1) / multiple * multiple; }
+
+}
+
+DescriptorMatrix::DescriptorMatrix(int rows, int cols, DescriptorLayout layout) : rows_(rows), cols_(cols), layout_(layout) {
+    if (rows < 0 || cols < 0) {
+        throw std::invalid_argument("Descriptor matrix dimensions must not be negative.");
+    }
+    row_stride_ = layout == DescriptorLayout::Interleaved ? roundUp(2 * cols, kAlignmentFloats) : 2 * roundUp(cols, kAlignmentFloats);
+    values_.assign(static_cast<size_t>(rows) * row_stride_, 0.0f);
+    orientations_.assign(rows, 0.0f);
+}
+
+DescriptorMatrix DescriptorMatrix::fromDescs(const std::vector<Desc>& descs, DescriptorLayout layout) {
+    const int cols = descs.empty() ? 0 : static_cast<int>(descs[0].descriptor.size());
+    DescriptorMatrix matrix(static_cast<int>(descs.size()), cols, layout);
+    for (int i = 0; i < matrix.rows(); i++) {
+        if (static_cast<int>(descs[i].descriptor.size()) != cols) {
+            throw std::invalid_argument("All descriptors must have the same length.");
+        }
+        matrix.setRow(i, descs[i].descriptor.data());
+        matrix.orientations()[i] = descs[i].dominant_orientation;
+    }
+    return matrix;
+}
+
+std::complex<float> DescriptorMatrix::at(int i, int k) const {
+    const float* values = row(i);
+    if (layout_ == DescriptorLayout::Interleaved) return {values[2 * k], values[2 * k + 1]};
+    return {values[k], values[splitOffset() + k]};
+}
+
+void DescriptorMatrix::setRow(int i, const std::complex<float>* coefficients) {
+    float* values = row(i);
+    for (int k = 0; k < cols_; k++) {
+        if (layout_ == DescriptorLayout::Interleaved) {
+            values[2 * k] = coefficients[k].real();
+            values[2 * k + 1] = coefficients[k].imag();
+        } else {
+            values[k] = coefficients[k].real();
+            values[splitOffset() + k] = coefficients[k].imag();
+        }
+    }
+}
+
+Desc DescriptorMatrix::toDesc(int i) const {
+    Desc desc{std::vector<std::complex<float>>(cols_), orientations_[i]};
+    for (int k = 0; k < cols_; k++) desc.descriptor[k] = at(i, k);
+    return desc;
+}
+
+std::vector<Desc> DescriptorMatrix::toDescs() const {
+    std::vector<Desc> descs;
+    descs.reserve(rows_);
+    for (int i = 0; i < rows_; i++) descs.push_back(toDesc(i));
+    return descs;
+}
+
+}
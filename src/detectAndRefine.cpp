@@ -0,0 +1,84 @@
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "keypointDetection.hpp"
+#include "refine.hpp"
+
+namespace refine {
+
+namespace {
+
+// level_view(octave, level) returns the LevelView<const T> of a DoG level.
+template <typename T, typename LevelViewAt>
+void detectAndRefineBands(const ss::ScaleSpace& DoG_scale_space, LevelViewAt level_view, float threshold, float value_scale,
+                          const cfg::SiftConfig& config, kp::KeyPointSet& keypoints, const exec::Executor& executor) {
+    const std::vector<kp::DetectionBand> bands = kp::planDetectionBands(DoG_scale_space);
+
+    std::vector<kp::KeyPointSet> band_keypoints(bands.size());
+    exec::orDefault(executor)(static_cast<int>(bands.size()), [&](int i) {
+        thread_local std::vector<kp::KeyPoint> candidates;
+        candidates.clear();
+
+        const kp::DetectionBand& band = bands[i];
+        kp::detectRowExtrema<T>(level_view(band.octave_idx, band.scale_idx - 1), level_view(band.octave_idx, band.scale_idx),
+                                level_view(band.octave_idx, band.scale_idx + 1), band.row_begin, band.row_end, band.octave_idx,
+                                band.scale_idx, threshold, value_scale, candidates);
+        if (candidates.empty()) return;
+
+        band_keypoints[i].append(candidates);
+        refineKeypoints(DoG_scale_space, band_keypoints[i], value_scale, config);
+    });
+
+    size_t total = keypoints.size();
+    for (const kp::KeyPointSet& band : band_keypoints) total += band.size();
+    keypoints.reserve(total);
+    for (const kp::KeyPointSet& band : band_keypoints) {
+        keypoints.append(band);
+    }
+}
+
+// threshold is for detection only; refinement takes its thresholds from config.
+void detectAndRefineIn(const ss::Pyramid& DoG_pyramid, float threshold, const cfg::SiftConfig& config, kp::KeyPointSet& keypoints,
+                       const exec::Executor& executor) {
+    if (DoG_pyramid.depth() == CV_16S) {
+        const float value_scale = DoG_pyramid.valueScale();
+        detectAndRefineBands<short>(DoG_pyramid.scaleSpace(), [&](int octave, int level) { return DoG_pyramid.view<short>(octave, level); },
+                                    threshold * value_scale, value_scale, config, keypoints, executor);
+        return;
+    }
+    detectAndRefineBands<float>(DoG_pyramid.scaleSpace(), [&](int octave, int level) { return DoG_pyramid.view(octave, level); },
+                                threshold, 1.0f, config, keypoints, executor);
+}
+
+void detectAndRefineIn(const ss::ScaleSpace& DoG_scale_space, float threshold, const cfg::SiftConfig& config, kp::KeyPointSet& keypoints,
+                       const exec::Executor& executor) {
+    detectAndRefineBands<float>(DoG_scale_space,
+                                [&](int octave, int level) { return ss::viewOf<const float>(DoG_scale_space[octave][level]); },
+                                threshold, 1.0f, config, keypoints, executor);
+}
+
+}
+
+void detectAndRefine(const ss::ScaleSpace& DoG_scale_space, const cfg::SiftConfig& config, kp::KeyPointSet& keypoints,
+                     const exec::Executor& executor) {
+    config.validate();
+    detectAndRefineIn(DoG_scale_space, config.contrast_threshold, config, keypoints, executor);
+}
+
+void detectAndRefine(const ss::Pyramid& DoG_pyramid, const cfg::SiftConfig& config, kp::KeyPointSet& keypoints,
+                     const exec::Executor& executor) {
+    config.validate();
+    detectAndRefineIn(DoG_pyramid, config.contrast_threshold, config, keypoints, executor);
+}
+
+void detectAndRefine(const ss::ScaleSpace& DoG_scale_space, float contrast_threshold, kp::KeyPointSet& keypoints,
+                     const exec::Executor& executor) {
+    detectAndRefineIn(DoG_scale_space, contrast_threshold, {}, keypoints, executor);
+}
+
+void detectAndRefine(const ss::Pyramid& DoG_pyramid, float contrast_threshold, kp::KeyPointSet& keypoints,
+                     const exec::Executor& executor) {
+    detectAndRefineIn(DoG_pyramid, contrast_threshold, {}, keypoints, executor);
+}
+
+}
@@ -0,0 +1,141 @@
+#include <stdexcept>
+#include "distance.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DESC_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace desc {
+
+namespace {
+
+float squaredDistanceScalar(const float* a, const float* b, int n) {
+    float sum = 0.0f;
+    for (int k = 0; k < n; ++k) {
+        const float diff = a[k] - b[k];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+#ifdef DESC_X86_KERNELS
+
+__attribute__((target("sse4.2"))) float squaredDistanceSSE42(const float* a, const float* b, int n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + k), _mm_loadu_ps(b + k));
+        const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + k + 4), _mm_loadu_ps(b + k + 4));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_hadd_ps(acc, acc);
+    acc = _mm_hadd_ps(acc, acc);
+    return _mm_cvtss_f32(acc) + squaredDistanceScalar(a + k, b + k, n - k);
+}
+
+__attribute__((target("avx2,fma"))) float squaredDistanceAVX2(const float* a, const float* b, int n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    int k = 0;
+    for (; k + 16 <= n; k += 16) {
+        const __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + k), _mm256_loadu_ps(b + k));
+        const __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + k + 8), _mm256_loadu_ps(b + k + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    if (k + 8 <= n) {
+        const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + k), _mm256_loadu_ps(b + k));
+        acc0 = _mm256_fmadd_ps(d, d, acc0);
+        k += 8;
+    }
+    const __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum) + squaredDistanceScalar(a + k, b + k, n - k);
+}
+
+__attribute__((target("avx512f"))) float squaredDistanceAVX512(const float* a, const float* b, int n) {
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    int k = 0;
+    for (; k + 32 <= n; k += 32) {
+        const __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + k), _mm512_loadu_ps(b + k));
+        const __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(a + k + 16), _mm512_loadu_ps(b + k + 16));
+        acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm512_fmadd_ps(d1, d1, acc1);
+    }
+    if (k < n) {
+        // Masked loads read zeros past n, which adds nothing to the sum
+        const int rest = n - k < 16 ? n - k : 16;
+        const __mmask16 mask = static_cast<__mmask16>((1u << rest) - 1u);
+        const __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + k), _mm512_maskz_loadu_ps(mask, b + k));
+        acc0 = _mm512_fmadd_ps(d, d, acc0);
+        k += rest;
+    }
+    // Reduced through memory: GCC 12's 512-bit lane extracts warn about their undefined upper halves
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, _mm512_add_ps(acc0, acc1));
+    float sum = 0.0f;
+    for (float lane : lanes) sum += lane;
+    return sum + squaredDistanceScalar(a + k, b + k, n - k);
+}
+
+#endif
+
+DistanceBackend detectDistanceBackend() {
+    for (DistanceBackend backend : {DistanceBackend::AVX512, DistanceBackend::AVX2, DistanceBackend::SSE42}) {
+        if (distanceBackendSupported(backend)) return backend;
+    }
+    return DistanceBackend::Scalar;
+}
+
+}
+
+bool distanceBackendSupported(DistanceBackend backend) {
+    switch (backend) {
+        case DistanceBackend::Scalar: return true;
+#ifdef DESC_X86_KERNELS
+        case DistanceBackend::SSE42: return __builtin_cpu_supports("sse4.2");
+        case DistanceBackend::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case DistanceBackend::AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return false;
+    }
+}
+
+SquaredDistanceKernel squaredDistanceKernel(DistanceBackend backend) {
+    if (!distanceBackendSupported(backend)) {
+        throw std::invalid_argument("Distance backend " + distanceBackendName(backend) + " is not supported on this CPU.");
+    }
+    switch (backend) {
+#ifdef DESC_X86_KERNELS
+        case DistanceBackend::SSE42: return squaredDistanceSSE42;
+        case DistanceBackend::AVX2: return squaredDistanceAVX2;
+        case DistanceBackend::AVX512: return squaredDistanceAVX512;
+#endif
+        default: return squaredDistanceScalar;
+    }
+}
+
+std::string distanceBackendName(DistanceBackend backend) {
+    switch (backend) {
+        case DistanceBackend::SSE42: return "SSE4.2";
+        case DistanceBackend::AVX2: return "AVX2";
+        case DistanceBackend::AVX512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+DistanceBackend activeDistanceBackend() {
+    static const DistanceBackend backend = detectDistanceBackend();
+    return backend;
+}
+
+float squaredDistance(const float* a, const float* b, int n) {
+    static const SquaredDistanceKernel kernel = squaredDistanceKernel(activeDistanceBackend());
+    return kernel(a, b, n);
+}
+
+}
@@ -2,7 +2,9 @@
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include <stdexcept>
+#include <array>
 #include "dog.hpp"
+#include "siftConfig.hpp"
 
 namespace dog {
 
@@ -61,4 +63,100 @@ void calculateDifferenceOfGaussians(const ss::ScaleSpace& scale_space, ss::Scale
   }
 }
 
-} 
+void subtractLevels(ss::LevelView<const float> upper, ss::LevelView<const float> lower, ss::LevelView<float> difference) {
+  for (int row = 0; row < difference.rows; row++) {
+    const float* upper_row = upper.row(row);
+    const float* lower_row = lower.row(row);
+    float* difference_row = difference.row(row);
+    for (int col = 0; col < difference.cols; col++) {
+      difference_row[col] = upper_row[col] - lower_row[col];
+    }
+  }
+}
+
+// Both inputs are within +-kFixedPointRange, so the difference is exact in int16.
+void subtractLevels(ss::LevelView<const short> upper, ss::LevelView<const short> lower, ss::LevelView<short> difference) {
+  for (int row = 0; row < difference.rows; row++) {
+    const short* upper_row = upper.row(row);
+    const short* lower_row = lower.row(row);
+    short* difference_row = difference.row(row);
+    for (int col = 0; col < difference.cols; col++) {
+      difference_row[col] = static_cast<short>(upper_row[col] - lower_row[col]);
+    }
+  }
+}
+
+namespace {
+
+// All differences of one octave in a single pass: each Gaussian row is read once and feeds the two
+// differences it belongs to, with the level loop unrolled for the compile-time level count.
+template <int Levels, typename T>
+void subtractOctave(const ss::Pyramid& gaussian_pyramid, ss::Pyramid& DoG_pyramid, int octave_idx) {
+  std::array<ss::LevelView<const T>, Levels> gaussian;
+  std::array<ss::LevelView<T>, Levels - 1> difference;
+  for (int level = 0; level < Levels; level++) {
+    gaussian[level] = gaussian_pyramid.view<T>(octave_idx, level);
+  }
+  for (int level = 0; level + 1 < Levels; level++) {
+    difference[level] = DoG_pyramid.view<T>(octave_idx, level);
+  }
+
+  for (int row = 0; row < difference[0].rows; row++) {
+    std::array<const T*, Levels> gaussian_rows;
+    std::array<T*, Levels - 1> difference_rows;
+    for (int level = 0; level < Levels; level++) gaussian_rows[level] = gaussian[level].row(row);
+    for (int level = 0; level + 1 < Levels; level++) difference_rows[level] = difference[level].row(row);
+
+    for (int col = 0; col < difference[0].cols; col++) {
+      T lower = gaussian_rows[0][col];
+      for (int level = 1; level < Levels; level++) {
+        const T upper = gaussian_rows[level][col];
+        difference_rows[level - 1][col] = static_cast<T>(upper - lower);
+        lower = upper;
+      }
+    }
+  }
+}
+
+}
+
+void calculateDifferenceOfGaussians(const ss::Pyramid& gaussian_pyramid, ss::Pyramid& DoG_pyramid) {
+  if (gaussian_pyramid.empty()) {
+    throw std::invalid_argument("Scale Space should not be empty.");
+  }
+  if (gaussian_pyramid.levelsPerOctave() < 2) {
+    throw std::invalid_argument("Number of images per octave should be at least 2.");
+  }
+  const int depth = gaussian_pyramid.depth();
+  if (depth != CV_32F && depth != CV_16S) {
+    throw std::invalid_argument("Gaussian pyramid must be of type CV_32F or CV_16S.");
+  }
+
+  DoG_pyramid.allocate(gaussian_pyramid.octaveSize(0), gaussian_pyramid.numOctaves(), gaussian_pyramid.levelsPerOctave() - 1, depth);
+  DoG_pyramid.setValueScale(gaussian_pyramid.valueScale());
+
+  // 5 and 7 Gaussian levels are 3 and 5 scales per octave; other counts subtract level by level
+  cfg::dispatchFixed<5, 7>(gaussian_pyramid.levelsPerOctave(), [&](auto levels) {
+    for (int octave_idx = 0; octave_idx < gaussian_pyramid.numOctaves(); octave_idx++) {
+      if constexpr (levels() > 0) {
+        if (depth == CV_16S) {
+          subtractOctave<levels(), short>(gaussian_pyramid, DoG_pyramid, octave_idx);
+        } else {
+          subtractOctave<levels(), float>(gaussian_pyramid, DoG_pyramid, octave_idx);
+        }
+        continue;
+      }
+      for (int image_idx = 1; image_idx < gaussian_pyramid.levelsPerOctave(); image_idx++) {
+        if (depth == CV_16S) {
+          subtractLevels(gaussian_pyramid.view<short>(octave_idx, image_idx), gaussian_pyramid.view<short>(octave_idx, image_idx - 1),
+                         DoG_pyramid.view<short>(octave_idx, image_idx - 1));
+        } else {
+          subtractLevels(gaussian_pyramid.view(octave_idx, image_idx), gaussian_pyramid.view(octave_idx, image_idx - 1),
+                         DoG_pyramid.view(octave_idx, image_idx - 1));
+        }
+      }
+    }
+  });
+}
+
+}
@@ -0,0 +1,31 @@
+#include <iostream>
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include "executor.hpp"
+
+namespace exec {
+
+Executor openCVExecutor() {
+    return [](int num_tasks, const std::function<void(int)>& task) {
+        cv::parallel_for_(cv::Range(0, num_tasks), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; i++) {
+                task(i);
+            }
+        });
+    };
+}
+
+Executor serialExecutor() {
+    return [](int num_tasks, const std::function<void(int)>& task) {
+        for (int i = 0; i < num_tasks; i++) {
+            task(i);
+        }
+    };
+}
+
+const Executor& orDefault(const Executor& executor) {
+    static const Executor default_executor = openCVExecutor();
+    return executor ? executor : default_executor;
+}
+
+}
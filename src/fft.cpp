@@ -0,0 +1,142 @@
+#include <iostream>
+#include <vector>
+#include <array>
+#include <complex>
+#include <numbers>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cmath>
+#include <stdexcept>
+#include "descriptor.hpp"
+
+namespace desc {
+
+namespace {
+
+bool isPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+// w[k] = exp(-2 pi i k / n), in double before rounding to float
+std::vector<std::complex<float>> makeTwiddles(int n) {
+    std::vector<std::complex<float>> w(n);
+    for (int k = 0; k < n; k++) {
+        const double angle = -2.0 * std::numbers::pi * k / n;
+        w[k] = {static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+    }
+    return w;
+}
+
+// Tables for runtime lengths, built once per length and never freed
+const std::complex<float>* twiddlesFor(int n) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<const std::vector<std::complex<float>>>> tables;
+    std::lock_guard lock(mutex);
+    auto& table = tables[n];
+    if (!table) table = std::make_unique<const std::vector<std::complex<float>>>(makeTwiddles(n));
+    return table->data();
+}
+
+template <int N>
+const std::complex<float>* fixedTwiddles() {
+    static const std::vector<std::complex<float>> table = makeTwiddles(N);
+    return table.data();
+}
+
+// Real FFT of power-of-two length n >= 2: the input is packed as n / 2 complex samples, transformed with an
+// iterative radix-2 FFT, and the two interleaved half-length spectra are separated with the twiddles.
+// FixedN > 0 fixes n at compile time so every loop has a constant trip count.
+template <int FixedN>
+void realFFTKernel(const float* input, int runtime_n, const std::complex<float>* w, std::complex<float>* output, bool half_spectrum) {
+    const int n = FixedN > 0 ? FixedN : runtime_n;
+    const int m = n / 2;
+
+    std::array<std::complex<float>, (FixedN > 0 ? FixedN / 2 : 1)> fixed_buffer;
+    std::vector<std::complex<float>> runtime_buffer;
+    std::complex<float>* z = fixed_buffer.data();
+    if constexpr (FixedN == 0) {
+        runtime_buffer.resize(m);
+        z = runtime_buffer.data();
+    }
+
+    int log_m = 0;
+    while ((1 << log_m) < m) log_m++;
+    for (int k = 0; k < m; k++) {
+        int reversed = 0;
+        for (int bit = 0; bit < log_m; bit++) reversed |= ((k >> bit) & 1) << (log_m - 1 - bit);
+        z[reversed] = {input[2 * k], input[2 * k + 1]};
+    }
+
+    // exp(-2 pi i j / len) is w[j * n / len]
+    for (int len = 2; len <= m; len <<= 1) {
+        const int stride = n / len;
+        for (int start = 0; start < m; start += len) {
+            for (int j = 0; j < len / 2; j++) {
+                const std::complex<float> t = w[j * stride] * z[start + j + len / 2];
+                const std::complex<float> u = z[start + j];
+                z[start + j] = u + t;
+                z[start + j + len / 2] = u - t;
+            }
+        }
+    }
+
+    output[0] = {z[0].real() + z[0].imag(), 0.0f};
+    output[m] = {z[0].real() - z[0].imag(), 0.0f};
+    for (int k = 1; k < m; k++) {
+        const std::complex<float> a = z[k];
+        const std::complex<float> b = std::conj(z[m - k]);
+        const std::complex<float> even = 0.5f * (a + b);
+        const std::complex<float> odd = std::complex<float>(0.0f, -0.5f) * (a - b);
+        output[k] = even + w[k] * odd;
+    }
+    if (!half_spectrum) {
+        for (int k = m + 1; k < n; k++) output[k] = std::conj(output[n - k]);
+    }
+}
+
+// Any length: direct sum over the twiddle table, w[(k * j) mod n], with no transcendental calls
+void tableDFT(const float* input, int n, const std::complex<float>* w, std::complex<float>* output, bool half_spectrum) {
+    const int outputs = half_spectrum ? n / 2 + 1 : n;
+    for (int k = 0; k < outputs; k++) {
+        std::complex<float> sum(0.0f, 0.0f);
+        int index = 0;
+        for (int j = 0; j < n; j++) {
+            sum += input[j] * w[index];
+            index += k;
+            if (index >= n) index -= n;
+        }
+        output[k] = sum;
+    }
+}
+
+}
+
+int spectrumLength(int n, bool half_spectrum) {
+    return half_spectrum ? n / 2 + 1 : n;
+}
+
+void calculateRealFFT(const float* input, int n, std::complex<float>* output, bool half_spectrum) {
+    if (n <= 0) {
+        throw std::invalid_argument("FFT length must be positive.");
+    }
+    switch (n) {
+        case 32: realFFTKernel<32>(input, n, fixedTwiddles<32>(), output, half_spectrum); return;
+        case 64: realFFTKernel<64>(input, n, fixedTwiddles<64>(), output, half_spectrum); return;
+        case 128: realFFTKernel<128>(input, n, fixedTwiddles<128>(), output, half_spectrum); return;
+        default: break;
+    }
+    if (n == 1) {
+        output[0] = {input[0], 0.0f};
+    } else if (isPowerOfTwo(n)) {
+        realFFTKernel<0>(input, n, twiddlesFor(n), output, half_spectrum);
+    } else {
+        tableDFT(input, n, twiddlesFor(n), output, half_spectrum);
+    }
+}
+
+std::vector<std::complex<float>> calculateRealFFT(const std::vector<float>& input, bool half_spectrum) {
+    std::vector<std::complex<float>> output(spectrumLength(static_cast<int>(input.size()), half_spectrum));
+    if (!input.empty()) calculateRealFFT(input.data(), static_cast<int>(input.size()), output.data(), half_spectrum);
+    return output;
+}
+
+}
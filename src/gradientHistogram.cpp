@@ -0,0 +1,174 @@
+#include <iostream>
+#include <vector>
+#include <array>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "histogram.hpp"
+
+namespace hist {
+
+namespace {
+
+constexpr int kOrientationBins = 36;
+
+// Central differences with the border replicated, the same on both paths
+struct Gradient {
+    float dx;
+    float dy;
+};
+
+Gradient gradientAt(ss::LevelView<const float> level, int row, int col) {
+    const int left = std::max(col - 1, 0), right = std::min(col + 1, level.cols - 1);
+    const int up = std::max(row - 1, 0), down = std::min(row + 1, level.rows - 1);
+    return {level.at(row, right) - level.at(row, left), level.at(down, col) - level.at(up, col)};
+}
+
+float orientationDegrees(float dx, float dy) {
+    float angle = std::atan2(dy, dx);
+    if (angle < 0) angle += 2 * std::numbers::pi_v<float>;
+    return angle * (180.0f / std::numbers::pi_v<float>);
+}
+
+// sample_at(y, x) returns {magnitude, orientation in degrees} of an in-bounds sample.
+template <typename SampleAt>
+void gatherGradientHistogram(int rows, int cols, SampleAt sample_at, const kp::KeyPoint& local, const LogPolarTable& table,
+    GradientHistogram& result) {
+    std::vector<float> bins(table.num_angle_bins * table.num_radius_bins, 0.0f);
+    std::array<float, kOrientationBins> orientation_bins{};
+
+    const int x0 = static_cast<int>(std::round(local.x));
+    const int y0 = static_cast<int>(std::round(local.y));
+    for (const LogPolarSample& sample : table.samples) {
+        const int x = x0 + sample.dx, y = y0 + sample.dy;
+        if (x < 0 || x >= cols || y < 0 || y >= rows) continue;
+
+        const auto [magnitude, orientation] = sample_at(y, x);
+        const float response = sample.weight * magnitude;
+        bins[sample.bin] += response;
+        orientation_bins[static_cast<int>(orientation * (kOrientationBins / 360.0f)) % kOrientationBins] += response;
+    }
+
+    result.histogram.resize(table.num_angle_bins);
+    for (int angle_bin = 0; angle_bin < table.num_angle_bins; angle_bin++) {
+        result.histogram[angle_bin].assign(bins.begin() + angle_bin * table.num_radius_bins,
+                                           bins.begin() + (angle_bin + 1) * table.num_radius_bins);
+    }
+    const int dominant_bin = std::max_element(orientation_bins.begin(), orientation_bins.end()) - orientation_bins.begin();
+    result.dominant_orientation = dominant_bin * (360.0f / kOrientationBins);
+}
+
+}
+
+void computeLevelMaps(ss::LevelView<const float> level, LevelMaps& maps) {
+    maps.intensity = level;
+    maps.magnitude.create(level.rows, level.cols, CV_32F);
+    cv::Mat dx(level.rows, level.cols, CV_32F), dy(level.rows, level.cols, CV_32F);
+
+    for (int row = 0; row < level.rows; row++) {
+        const float* up = level.row(std::max(row - 1, 0));
+        const float* centre = level.row(row);
+        const float* down = level.row(std::min(row + 1, level.rows - 1));
+        float* dx_row = dx.ptr<float>(row);
+        float* dy_row = dy.ptr<float>(row);
+        float* magnitude_row = maps.magnitude.ptr<float>(row);
+
+        // Interior columns are a straight vectorizable loop; the two border columns go through gradientAt
+        for (int col = 1; col < level.cols - 1; col++) {
+            dx_row[col] = centre[col + 1] - centre[col - 1];
+            dy_row[col] = down[col] - up[col];
+            magnitude_row[col] = std::sqrt(dx_row[col] * dx_row[col] + dy_row[col] * dy_row[col]);
+        }
+        for (int col : {0, level.cols - 1}) {
+            const Gradient gradient = gradientAt(level, row, col);
+            dx_row[col] = gradient.dx;
+            dy_row[col] = gradient.dy;
+            magnitude_row[col] = std::sqrt(gradient.dx * gradient.dx + gradient.dy * gradient.dy);
+        }
+    }
+
+    // Orientation through the same atan2 as the on-demand path, so both modes bin every sample alike
+    maps.orientation.create(level.rows, level.cols, CV_32F);
+    for (int row = 0; row < level.rows; row++) {
+        const float* dx_row = dx.ptr<float>(row);
+        const float* dy_row = dy.ptr<float>(row);
+        float* orientation_row = maps.orientation.ptr<float>(row);
+        for (int col = 0; col < level.cols; col++) {
+            orientation_row[col] = orientationDegrees(dx_row[col], dy_row[col]);
+        }
+    }
+}
+
+MapMode chooseMapMode(const std::vector<float>& window_sigmas, cv::Size level_size) {
+    // A precomputed sample costs about as much as an on-demand one, so precomputing pays off once the
+    // windows together visit more samples than the level has
+    double visited = 0.0;
+    for (float sigma : window_sigmas) {
+        const double radius = std::ceil(4.5 * sigma);
+        visited += (2 * radius + 1) * (2 * radius + 1);
+    }
+    return visited >= kPrecomputeCoverage * level_size.area() ? MapMode::Precomputed : MapMode::OnDemand;
+}
+
+LevelMapSet precomputeLevelMaps(const ss::ScaleSpace& gaussian_scale_space, const std::vector<OctavePlacement>& placements,
+    MapMode mode, const exec::Executor& executor) {
+    std::map<std::pair<int, int>, std::vector<float>> window_sigmas;
+    for (const OctavePlacement& placement : placements) {
+        window_sigmas[{placement.octave, placement.level}].push_back(placement.sigma);
+    }
+
+    LevelMapSet maps;
+    std::vector<std::pair<LevelMaps*, ss::LevelView<const float>>> to_build;
+    for (const auto& [key, sigmas] : window_sigmas) {
+        const ss::LevelView<const float> level = ss::viewOf<const float>(gaussian_scale_space[key.first][key.second]);
+        const MapMode level_mode = mode == MapMode::Automatic ? chooseMapMode(sigmas, cv::Size(level.cols, level.rows)) : mode;
+        if (level_mode == MapMode::Precomputed) to_build.push_back({&maps[key], level});
+    }
+
+    exec::orDefault(executor)(static_cast<int>(to_build.size()), [&](int i) {
+        computeLevelMaps(to_build[i].second, *to_build[i].first);
+    });
+    return maps;
+}
+
+void generateGradientHistogram(const ss::ScaleSpace& gaussian_scale_space, const OctavePlacement& placement, const LevelMaps* maps,
+    const cfg::SiftConfig& config, GradientHistogram& histogram) {
+    const ss::LevelView<const float> level = ss::viewOf<const float>(gaussian_scale_space[placement.octave][placement.level]);
+    const auto table = defaultLogPolarTableCache().get(placement.sigma, config.num_angle_bins, config.num_radius_bins);
+    if (maps) {
+        gatherGradientHistogram(level.rows, level.cols, [&](int y, int x) {
+            return std::make_pair(maps->magnitude.at<float>(y, x), maps->orientation.at<float>(y, x));
+        }, placement.local, *table, histogram);
+    } else {
+        gatherGradientHistogram(level.rows, level.cols, [&](int y, int x) {
+            const Gradient gradient = gradientAt(level, y, x);
+            return std::make_pair(std::sqrt(gradient.dx * gradient.dx + gradient.dy * gradient.dy),
+                                  orientationDegrees(gradient.dx, gradient.dy));
+        }, placement.local, *table, histogram);
+    }
+}
+
+void generateGradientHistograms(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPointSet& keypoints,
+    const cfg::SiftConfig& config, std::vector<GradientHistogram>& histograms, MapMode mode) {
+    std::vector<OctavePlacement> placements;
+    for (size_t i = 0; i < keypoints.size(); i++) {
+        if (keypoints.isKept(i)) placements.push_back(placeInOctave(gaussian_scale_space, keypoints[i], config));
+    }
+
+    const LevelMapSet maps = precomputeLevelMaps(gaussian_scale_space, placements, mode);
+    histograms.resize(placements.size());
+    for (size_t j = 0; j < placements.size(); j++) {
+        const auto it = maps.find({placements[j].octave, placements[j].level});
+        generateGradientHistogram(gaussian_scale_space, placements[j], it == maps.end() ? nullptr : &it->second, config, histograms[j]);
+    }
+}
+
+void generateGradientHistograms(const ss::Pyramid& gaussian_pyramid, const kp::KeyPointSet& keypoints, const cfg::SiftConfig& config,
+    std::vector<GradientHistogram>& histograms, MapMode mode) {
+    generateGradientHistograms(gaussian_pyramid.scaleSpace(), keypoints, config, histograms, mode);
+}
+
+}
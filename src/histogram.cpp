@@ -4,6 +4,11 @@
 #include <utility>
 #include <cmath>
 #include <algorithm> 
+#include <array>
+#include <stdexcept>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include "histogram.hpp"
 
 namespace hist {
@@ -40,34 +45,25 @@ float calculateGaussianWindowWeight(int dx, int dy, float sigma) {
     return std::exp(-dist_sq / (2.0f * sigma_window * sigma_window));
 }
 
-void generateLogPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint,
-    int num_angle_bins, int num_radius_bins, std::vector<std::vector<float>>& histogram) {
-    int image_height = image.size();
-    int image_width = image_height > 0 ? image[0].size() : 0;
-
-    histogram.assign(num_angle_bins, std::vector<float>(num_radius_bins, 0.0f));
-
-    int x0_int = static_cast<int>(std::round(keypoint.x));
-    int y0_int = static_cast<int>(std::round(keypoint.y));
+LogPolarTable buildLogPolarTable(float sigma, int num_angle_bins, int num_radius_bins) {
+    if (num_angle_bins <= 0 || num_radius_bins <= 0) {
+        throw std::invalid_argument("Histogram bin counts must be positive.");
+    }
 
-    float sigma = keypoint.scale_idx; 
+    LogPolarTable table;
+    table.sigma = sigma;
+    table.num_angle_bins = num_angle_bins;
+    table.num_radius_bins = num_radius_bins;
 
     float max_radius = 4.5f * sigma;
     if (max_radius <= 1e-6f) max_radius = 1e-6f;
     float log_max_radius = std::log(max_radius);
 
     auto offsets = generateCircularMask(max_radius);
+    table.samples.reserve(offsets.size());
+    table.radius = static_cast<int>(std::ceil(max_radius));
 
     for (const auto& [dx, dy] : offsets) {
-        int x = x0_int + dx;
-        int y = y0_int + dy;
-
-        // Boundary check for the 'image' (input_vec)
-        if (x < 0 || x >= image_width || y < 0 || y >= image_height)
-            continue; 
-
-        float intensity = image[y][x];
-
         float angle_degrees;
         float log_radius;
         if (dx == 0 && dy == 0) {
@@ -89,10 +85,204 @@ void generateLogPolarHistogram(const std::vector<std::vector<float>>& image, con
         int radius_bin = static_cast<int>(normalized_log_radius * (num_radius_bins)); 
         radius_bin = std::clamp(radius_bin, 0, num_radius_bins - 1); 
 
-        float weight = calculateGaussianWindowWeight(dx, dy, sigma);
+        table.samples.push_back({dx, dy, angle_bin * num_radius_bins + radius_bin, calculateGaussianWindowWeight(dx, dy, sigma)});
+    }
+
+    return table;
+}
+
+LogPolarTableCache::LogPolarTableCache(float sigma_step) : sigma_step_(sigma_step) {
+    if (sigma_step <= 0) {
+        throw std::invalid_argument("Sigma step must be positive.");
+    }
+}
+
+std::shared_ptr<const LogPolarTable> LogPolarTableCache::get(float sigma, int num_angle_bins, int num_radius_bins) {
+    const long long sigma_idx = std::llround(sigma / sigma_step_);
+    const Key key{sigma_idx, num_angle_bins, num_radius_bins};
+    {
+        std::shared_lock lock(mutex_);
+        auto it = tables_.find(key);
+        if (it != tables_.end()) return it->second;
+    }
+
+    // Built outside the lock; if another thread got there first its table is kept
+    auto table = std::make_shared<const LogPolarTable>(buildLogPolarTable(sigma_idx * sigma_step_, num_angle_bins, num_radius_bins));
+    std::unique_lock lock(mutex_);
+    return tables_.try_emplace(key, std::move(table)).first->second;
+}
+
+size_t LogPolarTableCache::size() const {
+    std::shared_lock lock(mutex_);
+    return tables_.size();
+}
+
+void LogPolarTableCache::clear() {
+    std::unique_lock lock(mutex_);
+    tables_.clear();
+}
+
+LogPolarTableCache& defaultLogPolarTableCache() {
+    static LogPolarTableCache cache;
+    return cache;
+}
+
+namespace {
+
+// Shapes with a compiled-in trip count; anything else takes the runtime path.
+constexpr int kFixedAngleBins = 8;
+constexpr int kFixedRadiusBins = 4;
+
+}
+
+namespace {
+
+// row_at(y) returns a pointer to row y of a height x width image.
+template <int AngleBins, int RadiusBins, typename RowAt>
+void gatherLogPolarHistogram(int image_height, int image_width, RowAt row_at, const kp::KeyPoint& keypoint, const LogPolarTable& table,
+    std::vector<std::vector<float>>& histogram) {
+    static_assert((AngleBins > 0) == (RadiusBins > 0), "Fix both bin counts or neither.");
+    constexpr bool fixed_shape = AngleBins > 0;
+    if constexpr (fixed_shape) {
+        if (table.num_angle_bins != AngleBins || table.num_radius_bins != RadiusBins) {
+            throw std::invalid_argument("Bin counts do not match the specialized histogram shape.");
+        }
+    }
+    const int angle_bins = fixed_shape ? AngleBins : table.num_angle_bins;
+    const int radius_bins = fixed_shape ? RadiusBins : table.num_radius_bins;
+
+    // Flat accumulator, [angle_bin * radius_bins + radius_bin]
+    std::array<float, fixed_shape ? AngleBins * RadiusBins : 1> fixed_bins{};
+    std::vector<float> runtime_bins;
+    float* bins = fixed_bins.data();
+    if constexpr (!fixed_shape) {
+        runtime_bins.assign(angle_bins * radius_bins, 0.0f);
+        bins = runtime_bins.data();
+    }
+
+    int x0_int = static_cast<int>(std::round(keypoint.x));
+    int y0_int = static_cast<int>(std::round(keypoint.y));
+
+    // Windows entirely inside the image skip the per-sample bounds test
+    const bool inside = x0_int - table.radius >= 0 && x0_int + table.radius < image_width &&
+                        y0_int - table.radius >= 0 && y0_int + table.radius < image_height;
+    if (inside) {
+        for (const LogPolarSample& sample : table.samples) {
+            bins[sample.bin] += sample.weight * row_at(y0_int + sample.dy)[x0_int + sample.dx];
+        }
+    } else {
+        for (const LogPolarSample& sample : table.samples) {
+            int x = x0_int + sample.dx;
+            int y = y0_int + sample.dy;
+            if (x < 0 || x >= image_width || y < 0 || y >= image_height)
+                continue; 
+
+            bins[sample.bin] += sample.weight * row_at(y)[x];
+        }
+    }
 
-        histogram[angle_bin][radius_bin] += weight * intensity;
+    histogram.resize(angle_bins);
+    for (int angle_bin = 0; angle_bin < angle_bins; angle_bin++) {
+        histogram[angle_bin].assign(bins + angle_bin * radius_bins, bins + (angle_bin + 1) * radius_bins);
     }
 }
 
 }
+
+template <int AngleBins, int RadiusBins>
+void logPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint, const LogPolarTable& table,
+    std::vector<std::vector<float>>& histogram) {
+    int image_height = image.size();
+    int image_width = image_height > 0 ? image[0].size() : 0;
+    gatherLogPolarHistogram<AngleBins, RadiusBins>(image_height, image_width, [&](int y) { return image[y].data(); }, keypoint, table,
+                                                   histogram);
+}
+
+template <int AngleBins, int RadiusBins>
+void logPolarHistogram(ss::LevelView<const float> image, const kp::KeyPoint& keypoint, const LogPolarTable& table,
+    std::vector<std::vector<float>>& histogram) {
+    gatherLogPolarHistogram<AngleBins, RadiusBins>(image.rows, image.cols, [&](int y) { return image.row(y); }, keypoint, table, histogram);
+}
+
+template void logPolarHistogram<0, 0>(const std::vector<std::vector<float>>&, const kp::KeyPoint&, const LogPolarTable&,
+                                      std::vector<std::vector<float>>&);
+template void logPolarHistogram<kFixedAngleBins, kFixedRadiusBins>(const std::vector<std::vector<float>>&, const kp::KeyPoint&,
+                                                                   const LogPolarTable&, std::vector<std::vector<float>>&);
+template void logPolarHistogram<0, 0>(ss::LevelView<const float>, const kp::KeyPoint&, const LogPolarTable&,
+                                      std::vector<std::vector<float>>&);
+template void logPolarHistogram<kFixedAngleBins, kFixedRadiusBins>(ss::LevelView<const float>, const kp::KeyPoint&, const LogPolarTable&,
+                                                                   std::vector<std::vector<float>>&);
+
+void generateLogPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint,
+    const LogPolarTable& table, std::vector<std::vector<float>>& histogram) {
+    if (table.num_angle_bins == kFixedAngleBins && table.num_radius_bins == kFixedRadiusBins) {
+        logPolarHistogram<kFixedAngleBins, kFixedRadiusBins>(image, keypoint, table, histogram);
+    } else {
+        logPolarHistogram<0, 0>(image, keypoint, table, histogram);
+    }
+}
+
+void generateLogPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint,
+    int num_angle_bins, int num_radius_bins, std::vector<std::vector<float>>& histogram) {
+    // The keypoint's scale index is the window sigma
+    const auto table = defaultLogPolarTableCache().get(keypoint.scale_idx, num_angle_bins, num_radius_bins);
+    generateLogPolarHistogram(image, keypoint, *table, histogram);
+}
+
+void generateLogPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& keypoint,
+    const cfg::SiftConfig& config, std::vector<std::vector<float>>& histogram) {
+    generateLogPolarHistogram(image, keypoint, config.num_angle_bins, config.num_radius_bins, histogram);
+}
+
+void generateLogPolarHistogram(ss::LevelView<const float> image, const kp::KeyPoint& keypoint,
+    const LogPolarTable& table, std::vector<std::vector<float>>& histogram) {
+    if (table.num_angle_bins == kFixedAngleBins && table.num_radius_bins == kFixedRadiusBins) {
+        logPolarHistogram<kFixedAngleBins, kFixedRadiusBins>(image, keypoint, table, histogram);
+    } else {
+        logPolarHistogram<0, 0>(image, keypoint, table, histogram);
+    }
+}
+
+void generateLogPolarHistogram(ss::LevelView<const float> image, const kp::KeyPoint& keypoint,
+    int num_angle_bins, int num_radius_bins, std::vector<std::vector<float>>& histogram) {
+    const auto table = defaultLogPolarTableCache().get(keypoint.scale_idx, num_angle_bins, num_radius_bins);
+    generateLogPolarHistogram(image, keypoint, *table, histogram);
+}
+
+void generateLogPolarHistogram(ss::LevelView<const float> image, const kp::KeyPoint& keypoint,
+    const cfg::SiftConfig& config, std::vector<std::vector<float>>& histogram) {
+    generateLogPolarHistogram(image, keypoint, config.num_angle_bins, config.num_radius_bins, histogram);
+}
+
+OctavePlacement placeInOctave(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPoint& keypoint, const cfg::SiftConfig& config) {
+    if (keypoint.octave_idx < 0 || keypoint.octave_idx >= static_cast<int>(gaussian_scale_space.size())) {
+        throw std::out_of_range("Keypoint octave is outside the scale space.");
+    }
+    const int levels = static_cast<int>(gaussian_scale_space[keypoint.octave_idx].size());
+    const float octave_scale = static_cast<float>(1 << keypoint.octave_idx);
+
+    OctavePlacement placement;
+    placement.octave = keypoint.octave_idx;
+    placement.level = std::clamp(static_cast<int>(std::round(keypoint.scale_idx)), 0, levels - 1);
+    // Same window as the keypoint's blur in its own octave: initial_scale * 2^(s / S)
+    placement.sigma = config.initial_scale * std::exp2(keypoint.scale_idx / config.scales_per_octave);
+    placement.local = keypoint;
+    placement.local.x /= octave_scale;
+    placement.local.y /= octave_scale;
+    return placement;
+}
+
+void generateOctaveLogPolarHistogram(const ss::ScaleSpace& gaussian_scale_space, const kp::KeyPoint& keypoint,
+    const cfg::SiftConfig& config, std::vector<std::vector<float>>& histogram) {
+    const OctavePlacement placement = placeInOctave(gaussian_scale_space, keypoint, config);
+    const auto table = defaultLogPolarTableCache().get(placement.sigma, config.num_angle_bins, config.num_radius_bins);
+    generateLogPolarHistogram(ss::viewOf<const float>(gaussian_scale_space[placement.octave][placement.level]), placement.local, *table,
+                              histogram);
+}
+
+void generateOctaveLogPolarHistogram(const ss::Pyramid& gaussian_pyramid, const kp::KeyPoint& keypoint,
+    const cfg::SiftConfig& config, std::vector<std::vector<float>>& histogram) {
+    generateOctaveLogPolarHistogram(gaussian_pyramid.scaleSpace(), keypoint, config, histogram);
+}
+
+}
@@ -1,8 +1,17 @@
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
 #include <opencv2/opencv.hpp>
 #include "keypointDetection.hpp"
 
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace kp {
   
 bool isLocalExtremaPerOctave(const ss::Octave& DoG_octave, int scale_idx, int row, int col, const float contrast_threshold){
@@ -38,28 +47,316 @@ void coarseKeypointDetection(const ss::ScaleSpace& DoG_scale_space, std::vector<
 
   for(int octave_idx = 0; octave_idx < DoG_scale_space.size(); octave_idx++){
     for(int scale_idx = 1 ; scale_idx < DoG_scale_space[octave_idx].size() - 1; scale_idx++){
+      const ss::Octave& octave = DoG_scale_space[octave_idx];
+      detectLevelExtrema<float>(ss::viewOf<const float>(octave[scale_idx - 1]), ss::viewOf<const float>(octave[scale_idx]),
+                                ss::viewOf<const float>(octave[scale_idx + 1]), octave_idx, scale_idx, contrast_threshold, 1.0f,
+                                keypoints);
+    }
+  }
+
+}
 
-      const cv::Mat& image = DoG_scale_space[octave_idx][scale_idx];
+namespace {
 
-      for(int row = 1; row < image.rows - 1; row++){
-        for(int col = 1; col < image.cols - 1; col++){
-          if ( isLocalExtremaPerOctave(DoG_scale_space[octave_idx], scale_idx, row, col, contrast_threshold) ) {
+inline void emitKeypoint(std::vector<KeyPoint>& keypoints, int row, int col, int octave_idx, int scale_idx, float value) {
+  const float x = static_cast<float>(col * (1 << octave_idx));
+  const float y = static_cast<float>(row * (1 << octave_idx));
+  keypoints.push_back({x, y, static_cast<float>(scale_idx), octave_idx, value});
+}
 
-            int x = col * (1 << octave_idx);
-            int y = row * (1 << octave_idx);
-            float val = image.at<float>(row, col);
-            keypoints.push_back({x, y, scale_idx, octave_idx, val});
-          }
+// Same test as isLocalExtremaPerOctave for columns [begin, end) of one row. rows[ds][dr] is row + dr - 1 of
+// level scale_idx + ds - 1.
+template <typename T>
+void scanRowScalar(const T* const (&rows)[3][3], int begin, int end, int row, int octave_idx, int scale_idx, float threshold,
+                   float value_scale, std::vector<KeyPoint>& keypoints){
+  for(int col = begin; col < end; col++){
+    const T val = rows[1][1][col];
+    if (std::abs(val) < threshold) continue;
 
+    bool is_max = true;
+    bool is_min = true;
+    for (int ds = 0; ds < 3 && (is_max || is_min); ds++) {
+      for (int dr = 0; dr < 3; dr++) {
+        const T* neighbors = rows[ds][dr] + col;
+        for (int dc = -1; dc <= 1; dc++) {
+          if (ds == 1 && dr == 1 && dc == 0) continue;
+          if (val <= neighbors[dc]) is_max = false;
+          if (val >= neighbors[dc]) is_min = false;
         }
       }
+    }
+
+    if (is_max || is_min) {
+      emitKeypoint(keypoints, row, col, octave_idx, scale_idx, val / value_scale);
+    }
+  }
+}
+
+// Vector body for float rows; returns the first column left for the scalar tail. A lane is an extremum iff
+// it passes the contrast test and is strictly above the max (or below the min) of its 26 neighbours, which
+// is the scalar test rearranged, so the output is identical for finite input.
+int scanRowVector(const float* const (&rows)[3][3], int begin, int end, int row, int octave_idx, int scale_idx, float threshold,
+                  float value_scale, std::vector<KeyPoint>& keypoints){
+  int col = begin;
+#if defined(__AVX2__) && defined(__FMA__)
+  const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+  const __m256 vthreshold = _mm256_set1_ps(threshold);
+  for (; col <= end - 8; col += 8) {
+    const __m256 centre = _mm256_loadu_ps(rows[1][1] + col);
+    int contrast = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_andnot_ps(sign_mask, centre), vthreshold, _CMP_GE_OQ));
+    if (!contrast) continue;
+
+    __m256 hi = _mm256_max_ps(_mm256_loadu_ps(rows[1][1] + col - 1), _mm256_loadu_ps(rows[1][1] + col + 1));
+    __m256 lo = _mm256_min_ps(_mm256_loadu_ps(rows[1][1] + col - 1), _mm256_loadu_ps(rows[1][1] + col + 1));
+    for (int ds = 0; ds < 3; ds++) {
+      for (int dr = 0; dr < 3; dr++) {
+        if (ds == 1 && dr == 1) continue;
+        const float* neighbors = rows[ds][dr] + col;
+        const __m256 left = _mm256_loadu_ps(neighbors - 1);
+        const __m256 middle = _mm256_loadu_ps(neighbors);
+        const __m256 right = _mm256_loadu_ps(neighbors + 1);
+        hi = _mm256_max_ps(hi, _mm256_max_ps(_mm256_max_ps(left, middle), right));
+        lo = _mm256_min_ps(lo, _mm256_min_ps(_mm256_min_ps(left, middle), right));
+      }
+    }
+
+    int extrema = contrast & _mm256_movemask_ps(_mm256_or_ps(_mm256_cmp_ps(centre, hi, _CMP_GT_OQ), _mm256_cmp_ps(centre, lo, _CMP_LT_OQ)));
+    while (extrema) {
+      int lane = __builtin_ctz(extrema);
+      emitKeypoint(keypoints, row, col + lane, octave_idx, scale_idx, rows[1][1][col + lane] / value_scale);
+      extrema &= extrema - 1;
+    }
+  }
+#elif defined(__ARM_NEON)
+  const float32x4_t vthreshold = vdupq_n_f32(threshold);
+  for (; col <= end - 4; col += 4) {
+    const float32x4_t centre = vld1q_f32(rows[1][1] + col);
+    uint32x4_t contrast = vcgeq_f32(vabsq_f32(centre), vthreshold);
+    if (vmaxvq_u32(contrast) == 0) continue;
+
+    float32x4_t hi = vmaxq_f32(vld1q_f32(rows[1][1] + col - 1), vld1q_f32(rows[1][1] + col + 1));
+    float32x4_t lo = vminq_f32(vld1q_f32(rows[1][1] + col - 1), vld1q_f32(rows[1][1] + col + 1));
+    for (int ds = 0; ds < 3; ds++) {
+      for (int dr = 0; dr < 3; dr++) {
+        if (ds == 1 && dr == 1) continue;
+        const float* neighbors = rows[ds][dr] + col;
+        const float32x4_t left = vld1q_f32(neighbors - 1);
+        const float32x4_t middle = vld1q_f32(neighbors);
+        const float32x4_t right = vld1q_f32(neighbors + 1);
+        hi = vmaxq_f32(hi, vmaxq_f32(vmaxq_f32(left, middle), right));
+        lo = vminq_f32(lo, vminq_f32(vminq_f32(left, middle), right));
+      }
+    }
+
+    uint32_t lanes[4];
+    vst1q_u32(lanes, vandq_u32(contrast, vorrq_u32(vcgtq_f32(centre, hi), vcltq_f32(centre, lo))));
+    for (int lane = 0; lane < 4; lane++) {
+      if (lanes[lane]) emitKeypoint(keypoints, row, col + lane, octave_idx, scale_idx, rows[1][1][col + lane] / value_scale);
+    }
+  }
+#endif
+  return col;
+}
+
+// The same vector test on int16 rows (the scaled int16 pyramid), 16 / 8 lanes at a time. Samples are
+// integers, so |v| >= threshold is |v| >= ceil(threshold); above the int16 range nothing passes and the
+// scalar tail is left to report that.
+int scanRowVector(const short* const (&rows)[3][3], int begin, int end, int row, int octave_idx, int scale_idx, float threshold,
+                  float value_scale, std::vector<KeyPoint>& keypoints){
+  int col = begin;
+  const float int_threshold = std::max(0.0f, std::ceil(threshold));
+  if (int_threshold > 32767.0f) return col;
+  const short min_contrast = static_cast<short>(int_threshold);
+#if defined(__AVX2__) && defined(__FMA__)
+  // cmpgt against threshold - 1 is cmpge against threshold
+  const __m256i vthreshold = _mm256_set1_epi16(static_cast<short>(min_contrast - 1));
+  for (; col <= end - 16; col += 16) {
+    const __m256i centre = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[1][1] + col));
+    const __m256i contrast = _mm256_cmpgt_epi16(_mm256_abs_epi16(centre), vthreshold);
+    if (_mm256_testz_si256(contrast, contrast)) continue;
+
+    auto load = [](const short* ptr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)); };
+    __m256i hi = _mm256_max_epi16(load(rows[1][1] + col - 1), load(rows[1][1] + col + 1));
+    __m256i lo = _mm256_min_epi16(load(rows[1][1] + col - 1), load(rows[1][1] + col + 1));
+    for (int ds = 0; ds < 3; ds++) {
+      for (int dr = 0; dr < 3; dr++) {
+        if (ds == 1 && dr == 1) continue;
+        const short* neighbors = rows[ds][dr] + col;
+        const __m256i left = load(neighbors - 1);
+        const __m256i middle = load(neighbors);
+        const __m256i right = load(neighbors + 1);
+        hi = _mm256_max_epi16(hi, _mm256_max_epi16(_mm256_max_epi16(left, middle), right));
+        lo = _mm256_min_epi16(lo, _mm256_min_epi16(_mm256_min_epi16(left, middle), right));
+      }
+    }
+
+    // movemask_epi8 gives two bits per 16-bit lane; keep the low one
+    const __m256i is_extremum = _mm256_and_si256(contrast, _mm256_or_si256(_mm256_cmpgt_epi16(centre, hi), _mm256_cmpgt_epi16(lo, centre)));
+    unsigned extrema = static_cast<unsigned>(_mm256_movemask_epi8(is_extremum)) & 0x55555555u;
+    while (extrema) {
+      int lane = __builtin_ctz(extrema) / 2;
+      emitKeypoint(keypoints, row, col + lane, octave_idx, scale_idx, rows[1][1][col + lane] / value_scale);
+      extrema &= extrema - 1;
+    }
+  }
+#elif defined(__ARM_NEON)
+  const int16x8_t vthreshold = vdupq_n_s16(min_contrast);
+  for (; col <= end - 8; col += 8) {
+    const int16x8_t centre = vld1q_s16(rows[1][1] + col);
+    uint16x8_t contrast = vcgeq_s16(vabsq_s16(centre), vthreshold);
+    if (vmaxvq_u16(contrast) == 0) continue;
+
+    int16x8_t hi = vmaxq_s16(vld1q_s16(rows[1][1] + col - 1), vld1q_s16(rows[1][1] + col + 1));
+    int16x8_t lo = vminq_s16(vld1q_s16(rows[1][1] + col - 1), vld1q_s16(rows[1][1] + col + 1));
+    for (int ds = 0; ds < 3; ds++) {
+      for (int dr = 0; dr < 3; dr++) {
+        if (ds == 1 && dr == 1) continue;
+        const short* neighbors = rows[ds][dr] + col;
+        const int16x8_t left = vld1q_s16(neighbors - 1);
+        const int16x8_t middle = vld1q_s16(neighbors);
+        const int16x8_t right = vld1q_s16(neighbors + 1);
+        hi = vmaxq_s16(hi, vmaxq_s16(vmaxq_s16(left, middle), right));
+        lo = vminq_s16(lo, vminq_s16(vminq_s16(left, middle), right));
+      }
+    }
+
+    uint16_t lanes[8];
+    vst1q_u16(lanes, vandq_u16(contrast, vorrq_u16(vcgtq_s16(centre, hi), vcltq_s16(centre, lo))));
+    for (int lane = 0; lane < 8; lane++) {
+      if (lanes[lane]) emitKeypoint(keypoints, row, col + lane, octave_idx, scale_idx, rows[1][1][col + lane] / value_scale);
+    }
+  }
+#else
+  (void)min_contrast;
+#endif
+  return col;
+}
+
+}
+
+// Row-oriented scan: the contrast test runs on a whole vector of centres first, and only vectors with a
+// surviving lane pay for the 26-neighbour min / max.
+template <typename T>
+void detectRowExtrema(ss::LevelView<const T> below, ss::LevelView<const T> level, ss::LevelView<const T> above, int row_begin,
+                      int row_end, int octave_idx, int scale_idx, float threshold, float value_scale, std::vector<KeyPoint>& keypoints){
+
+  const ss::LevelView<const T> levels[3] = {below, level, above};
+
+  for(int row = row_begin; row < row_end; row++){
+    const T* rows[3][3];
+    for (int ds = 0; ds < 3; ds++) {
+      for (int dr = 0; dr < 3; dr++) {
+        rows[ds][dr] = levels[ds].row(row + dr - 1);
+      }
+    }
+
+    int col = scanRowVector(rows, 1, level.cols - 1, row, octave_idx, scale_idx, threshold, value_scale, keypoints);
+    scanRowScalar(rows, col, level.cols - 1, row, octave_idx, scale_idx, threshold, value_scale, keypoints);
+  }
+}
+
+template void detectRowExtrema<float>(ss::LevelView<const float>, ss::LevelView<const float>, ss::LevelView<const float>,
+                                      int, int, int, int, float, float, std::vector<KeyPoint>&);
+template void detectRowExtrema<short>(ss::LevelView<const short>, ss::LevelView<const short>, ss::LevelView<const short>,
+                                      int, int, int, int, float, float, std::vector<KeyPoint>&);
+
+std::vector<DetectionBand> planDetectionBands(const ss::ScaleSpace& DoG_scale_space, int rows_per_band){
+  if (rows_per_band <= 0) {
+    throw std::invalid_argument("Rows per band must be positive.");
+  }
 
+  std::vector<DetectionBand> bands;
+  for (int octave_idx = 0; octave_idx < static_cast<int>(DoG_scale_space.size()); octave_idx++) {
+    const ss::Octave& octave = DoG_scale_space[octave_idx];
+    const int rows = octave[0].rows;
+    for (int scale_idx = 1; scale_idx < static_cast<int>(octave.size()) - 1; scale_idx++) {
+      for (int row = 1; row < rows - 1; row += rows_per_band) {
+        bands.push_back({octave_idx, scale_idx, row, std::min(row + rows_per_band, rows - 1)});
+      }
     }
   }
+  return bands;
+}
+
+namespace {
+
+// level_view(octave, level) returns the LevelView<const T> of a DoG level.
+template <typename T, typename LevelViewAt>
+void detectInBands(const std::vector<DetectionBand>& bands, LevelViewAt level_view, float threshold, float value_scale,
+                   std::vector<KeyPoint>& keypoints, const exec::Executor& executor){
+
+  std::vector<std::vector<KeyPoint>> band_keypoints(bands.size());
+  exec::orDefault(executor)(static_cast<int>(bands.size()), [&](int i) {
+    const DetectionBand& band = bands[i];
+    detectRowExtrema<T>(level_view(band.octave_idx, band.scale_idx - 1), level_view(band.octave_idx, band.scale_idx),
+                        level_view(band.octave_idx, band.scale_idx + 1), band.row_begin, band.row_end, band.octave_idx,
+                        band.scale_idx, threshold, value_scale, band_keypoints[i]);
+  });
 
+  size_t total = keypoints.size();
+  for (const auto& band : band_keypoints) total += band.size();
+  keypoints.reserve(total);
+  for (const auto& band : band_keypoints) {
+    keypoints.insert(keypoints.end(), band.begin(), band.end());
+  }
+}
+
+}
+
+template <typename T>
+void detectLevelExtrema(ss::LevelView<const T> below, ss::LevelView<const T> level, ss::LevelView<const T> above,
+                        int octave_idx, int scale_idx, float threshold, float value_scale, std::vector<KeyPoint>& keypoints){
+  detectRowExtrema(below, level, above, 1, level.rows - 1, octave_idx, scale_idx, threshold, value_scale, keypoints);
 }
 
+template void detectLevelExtrema<float>(ss::LevelView<const float>, ss::LevelView<const float>, ss::LevelView<const float>,
+                                        int, int, float, float, std::vector<KeyPoint>&);
+template void detectLevelExtrema<short>(ss::LevelView<const short>, ss::LevelView<const short>, ss::LevelView<const short>,
+                                        int, int, float, float, std::vector<KeyPoint>&);
 
+namespace {
+
+// Samples are compared as stored; only the contrast threshold is moved into the fixed-point domain.
+void coarseFixedPointDetection(const ss::Pyramid& DoG_pyramid, std::vector<KeyPoint>& keypoints, const float contrast_threshold){
+  const float value_scale = DoG_pyramid.valueScale();
+  for(int octave_idx = 0; octave_idx < DoG_pyramid.numOctaves(); octave_idx++){
+    for(int scale_idx = 1; scale_idx < DoG_pyramid.levelsPerOctave() - 1; scale_idx++){
+      detectLevelExtrema<short>(DoG_pyramid.view<short>(octave_idx, scale_idx - 1), DoG_pyramid.view<short>(octave_idx, scale_idx),
+                                DoG_pyramid.view<short>(octave_idx, scale_idx + 1), octave_idx, scale_idx,
+                                contrast_threshold * value_scale, value_scale, keypoints);
+    }
+  }
 }
 
+}
 
+void coarseKeypointDetection(const ss::Pyramid& DoG_pyramid, std::vector<KeyPoint>& keypoints, const float contrast_threshold){
+  if (DoG_pyramid.depth() == CV_16S) {
+    coarseFixedPointDetection(DoG_pyramid, keypoints, contrast_threshold);
+    return;
+  }
+  coarseKeypointDetection(DoG_pyramid.scaleSpace(), keypoints, contrast_threshold);
+}
+
+void coarseKeypointDetection(const ss::ScaleSpace& DoG_scale_space, std::vector<KeyPoint>& keypoints, const float contrast_threshold,
+                             const exec::Executor& executor){
+  detectInBands<float>(planDetectionBands(DoG_scale_space),
+                       [&](int octave, int level) { return ss::viewOf<const float>(DoG_scale_space[octave][level]); },
+                       contrast_threshold, 1.0f, keypoints, executor);
+}
+
+void coarseKeypointDetection(const ss::Pyramid& DoG_pyramid, std::vector<KeyPoint>& keypoints, const float contrast_threshold,
+                             const exec::Executor& executor){
+  const std::vector<DetectionBand> bands = planDetectionBands(DoG_pyramid.scaleSpace());
+
+  if (DoG_pyramid.depth() == CV_16S) {
+    const float value_scale = DoG_pyramid.valueScale();
+    detectInBands<short>(bands, [&](int octave, int level) { return DoG_pyramid.view<short>(octave, level); },
+                         contrast_threshold * value_scale, value_scale, keypoints, executor);
+    return;
+  }
+  detectInBands<float>(bands, [&](int octave, int level) { return DoG_pyramid.view(octave, level); },
+                       contrast_threshold, 1.0f, keypoints, executor);
+}
+
+}
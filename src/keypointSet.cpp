@@ -0,0 +1,93 @@
+#include <iostream>
+#include <vector>
+#include "keypointSet.hpp"
+
+namespace kp {
+
+KeyPointSet::KeyPointSet(const std::vector<KeyPoint>& keypoints) {
+    append(keypoints);
+}
+
+void KeyPointSet::reserve(size_t capacity) {
+    x_.reserve(capacity);
+    y_.reserve(capacity);
+    scale_idx_.reserve(capacity);
+    octave_idx_.reserve(capacity);
+    DoG_value_.reserve(capacity);
+    mask_.reserve(capacity);
+}
+
+void KeyPointSet::clear() {
+    x_.clear();
+    y_.clear();
+    scale_idx_.clear();
+    octave_idx_.clear();
+    DoG_value_.clear();
+    mask_.clear();
+}
+
+void KeyPointSet::push_back(const KeyPoint& keypoint) {
+    x_.push_back(keypoint.x);
+    y_.push_back(keypoint.y);
+    scale_idx_.push_back(keypoint.scale_idx);
+    octave_idx_.push_back(keypoint.octave_idx);
+    DoG_value_.push_back(keypoint.DoG_value);
+    mask_.push_back(1);
+}
+
+void KeyPointSet::append(const std::vector<KeyPoint>& keypoints) {
+    reserve(size() + keypoints.size());
+    for (const KeyPoint& keypoint : keypoints) {
+        push_back(keypoint);
+    }
+}
+
+void KeyPointSet::append(const KeyPointSet& other) {
+    reserve(size() + other.size());
+    for (size_t i = 0; i < other.size(); i++) {
+        if (other.isKept(i)) push_back(other[i]);
+    }
+}
+
+void KeyPointSet::set(size_t i, const KeyPoint& keypoint) {
+    x_[i] = keypoint.x;
+    y_[i] = keypoint.y;
+    scale_idx_[i] = keypoint.scale_idx;
+    octave_idx_[i] = keypoint.octave_idx;
+    DoG_value_[i] = keypoint.DoG_value;
+}
+
+size_t KeyPointSet::compact() {
+    size_t kept = 0;
+    for (size_t i = 0; i < size(); i++) {
+        if (!mask_[i]) continue;
+        if (kept != i) {
+            x_[kept] = x_[i];
+            y_[kept] = y_[i];
+            scale_idx_[kept] = scale_idx_[i];
+            octave_idx_[kept] = octave_idx_[i];
+            DoG_value_[kept] = DoG_value_[i];
+            mask_[kept] = 1;
+        }
+        kept++;
+    }
+
+    x_.resize(kept);
+    y_.resize(kept);
+    scale_idx_.resize(kept);
+    octave_idx_.resize(kept);
+    DoG_value_.resize(kept);
+    mask_.resize(kept);
+    return kept;
+}
+
+std::vector<KeyPoint> KeyPointSet::toVector() const {
+    std::vector<KeyPoint> keypoints;
+    keypoints.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+        keypoints.push_back((*this)[i]);
+    }
+    return keypoints;
+}
+
+}
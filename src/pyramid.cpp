@@ -0,0 +1,113 @@
+#include <iostream>
+#include <vector>
+#include <new>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "pyramid.hpp"
+
+namespace ss {
+
+Pyramid::Pyramid(cv::Size base_size, int numOctaves, int levelsPerOctave, int depth) {
+    allocate(base_size, numOctaves, levelsPerOctave, depth);
+}
+
+void Pyramid::AlignedFree::operator()(unsigned char* ptr) const {
+    ::operator delete[](ptr, std::align_val_t(kAlignment));
+}
+
+void Pyramid::allocate(cv::Size base_size, int numOctaves, int levelsPerOctave, int depth) {
+    if (base_size.width <= 0 || base_size.height <= 0) {
+        throw std::invalid_argument("Pyramid base size must be positive.");
+    }
+    if (numOctaves <= 0 || levelsPerOctave <= 0) {
+        throw std::invalid_argument("Number of octaves and levels per octave must be positive.");
+    }
+
+    if (arena_ && depth == depth_ && numOctaves == num_octaves_ && levelsPerOctave == levels_per_octave_ &&
+        octave_sizes_[0] == base_size) {
+        return;
+    }
+
+    const size_t elem_size = CV_ELEM_SIZE1(depth);
+
+    std::vector<cv::Size> octave_sizes(numOctaves);
+    std::vector<size_t> octave_strides(numOctaves);
+    std::vector<size_t> level_offsets(static_cast<size_t>(numOctaves) * levelsPerOctave);
+
+    size_t total_bytes = 0;
+    for (int octave = 0; octave < numOctaves; octave++) {
+        octave_sizes[octave] = octave == 0 ? base_size
+                             : cv::Size(cvRound(octave_sizes[octave - 1].width * 0.5), cvRound(octave_sizes[octave - 1].height * 0.5));
+        if (octave_sizes[octave].width <= 0 || octave_sizes[octave].height <= 0) {
+            throw std::invalid_argument("Too many octaves for the pyramid base size.");
+        }
+
+        size_t row_bytes = (octave_sizes[octave].width * elem_size + kAlignment - 1) / kAlignment * kAlignment;
+        octave_strides[octave] = row_bytes / elem_size;
+
+        for (int level = 0; level < levelsPerOctave; level++) {
+            level_offsets[octave * levelsPerOctave + level] = total_bytes;
+            total_bytes += row_bytes * octave_sizes[octave].height;
+        }
+    }
+
+    arena_.reset(static_cast<unsigned char*>(::operator new[](total_bytes, std::align_val_t(kAlignment))));
+    arena_bytes_ = total_bytes;
+    depth_ = depth;
+    num_octaves_ = numOctaves;
+    levels_per_octave_ = levelsPerOctave;
+    octave_sizes_ = std::move(octave_sizes);
+    octave_strides_ = std::move(octave_strides);
+    level_offsets_ = std::move(level_offsets);
+
+    headers_.assign(numOctaves, Octave(levelsPerOctave));
+    for (int octave = 0; octave < numOctaves; octave++) {
+        for (int level = 0; level < levelsPerOctave; level++) {
+            headers_[octave][level] = cv::Mat(octave_sizes_[octave], CV_MAKETYPE(depth_, 1), levelData(octave, level),
+                                              octave_strides_[octave] * elem_size);
+        }
+    }
+}
+
+void Pyramid::setValueScale(float value_scale) {
+    if (!(value_scale > 0)) {
+        throw std::invalid_argument("Pyramid value scale must be positive.");
+    }
+    value_scale_ = value_scale;
+}
+
+unsigned char* Pyramid::levelData(int octave, int level) const {
+    if (octave < 0 || octave >= num_octaves_ || level < 0 || level >= levels_per_octave_) {
+        throw std::out_of_range("Pyramid level index is out of bounds.");
+    }
+    return arena_.get() + level_offsets_[octave * levels_per_octave_ + level];
+}
+
+void Pyramid::checkDepth(int depth) const {
+    if (depth != depth_) {
+        throw std::invalid_argument("Pyramid view element type does not match the pyramid depth.");
+    }
+}
+
+void quantizeLevel(LevelView<const float> src, LevelView<short> dst, float value_scale) {
+    for (int row = 0; row < dst.rows; row++) {
+        const float* in = src.row(row);
+        short* out = dst.row(row);
+        for (int col = 0; col < dst.cols; col++) {
+            out[col] = cv::saturate_cast<short>(in[col] * value_scale);
+        }
+    }
+}
+
+void dequantizeLevel(LevelView<const short> src, LevelView<float> dst, float value_scale) {
+    const float inverse_scale = 1.0f / value_scale;
+    for (int row = 0; row < dst.rows; row++) {
+        const short* in = src.row(row);
+        float* out = dst.row(row);
+        for (int col = 0; col < dst.cols; col++) {
+            out[col] = in[col] * inverse_scale;
+        }
+    }
+}
+
+}
@@ -6,49 +6,82 @@
 namespace refine {
 
 // -------- Matrix Math Utilities --------
-float calculateDeterminant(std::vector<std::vector<float>>& Hessian) {
+float determinant(const Mat3& m) {
     float det = 0;
     for (int col = 0; col < 3; col++) {
-        float sum = Hessian[0][col] * (
-            Hessian[1][(col + 1) % 3] * Hessian[2][(col + 2) % 3] -
-            Hessian[1][(col + 2) % 3] * Hessian[2][(col + 1) % 3]);
+        float sum = m[0][col] * (
+            m[1][(col + 1) % 3] * m[2][(col + 2) % 3] -
+            m[1][(col + 2) % 3] * m[2][(col + 1) % 3]);
         det += sum;
     }
     return det;
 }
 
-std::vector<std::vector<float>> calculateAdjugate(std::vector<std::vector<float>>& Hessian) {
-    std::vector<std::vector<float>> Adjugate(3, std::vector<float>(3));
-
+Mat3 adjugate(const Mat3& m) {
+    Mat3 adj;
     for (int row = 0; row < 3; row++) {
         for (int col = 0; col < 3; col++) {
-            float cofactor = Hessian[(row + 1) % 3][(col + 1) % 3] * Hessian[(row + 2) % 3][(col + 2) % 3]
-                           - Hessian[(row + 1) % 3][(col + 2) % 3] * Hessian[(row + 2) % 3][(col + 1) % 3];
-            Adjugate[col][row] = cofactor; 
+            adj[col][row] = m[(row + 1) % 3][(col + 1) % 3] * m[(row + 2) % 3][(col + 2) % 3]
+                          - m[(row + 1) % 3][(col + 2) % 3] * m[(row + 2) % 3][(col + 1) % 3];
         }
     }
-    return Adjugate;
+    return adj;
 }
 
-std::vector<std::vector<float>> calculateInverse(std::vector<std::vector<float>>& Hessian) {
-    std::vector<std::vector<float>> Adjugate = calculateAdjugate(Hessian);
-    float det = calculateDeterminant(Hessian);
+Mat3 inverse(const Mat3& m) {
+    Mat3 adj = adjugate(m);
+    float det = determinant(m);
+    Mat3 inv{};
     if (std::abs(det) < 1e-6f) {
-        return std::vector<std::vector<float>>(3, std::vector<float>(3, 0));
+        return inv;
     }
-
-    std::vector<std::vector<float>> Inverse(3, std::vector<float>(3));
     for (int row = 0; row < 3; row++) {
         for (int col = 0; col < 3; col++) {
-            Inverse[row][col] = Adjugate[row][col] / det;
+            inv[row][col] = adj[row][col] / det;
         }
     }
-    return Inverse;
+    return inv;
+}
+
+namespace {
+
+Mat3 toMat3(const std::vector<std::vector<float>>& m) {
+    return {{{m[0][0], m[0][1], m[0][2]}, {m[1][0], m[1][1], m[1][2]}, {m[2][0], m[2][1], m[2][2]}}};
+}
+
+std::vector<std::vector<float>> toVector(const Mat3& m) {
+    return {{m[0][0], m[0][1], m[0][2]}, {m[1][0], m[1][1], m[1][2]}, {m[2][0], m[2][1], m[2][2]}};
+}
+
+}
+
+float calculateDeterminant(std::vector<std::vector<float>>& Hessian) {
+    return determinant(toMat3(Hessian));
+}
+
+std::vector<std::vector<float>> calculateAdjugate(std::vector<std::vector<float>>& Hessian) {
+    return toVector(adjugate(toMat3(Hessian)));
+}
+
+std::vector<std::vector<float>> calculateInverse(std::vector<std::vector<float>>& Hessian) {
+    return toVector(inverse(toMat3(Hessian)));
 }
 
 // -------- DoG keypoint refinement --------
 
-float accessScaleSpace(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint) {
+namespace {
+
+// Fixed-point (CV_16S) levels are widened to float one sample at a time, only where refinement reads them.
+float sampleLevel(const cv::Mat& image, int row, int col, float value_scale) {
+    if (image.depth() == CV_16S) {
+        return image.at<short>(row, col) / value_scale;
+    }
+    return image.at<float>(row, col);
+}
+
+}
+
+float accessScaleSpace(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint, float value_scale) {
     if (keypoint.octave_idx < 0 || keypoint.octave_idx >= DoG_scale_space.size()) {
         throw std::out_of_range("Octave index is out of bounds for ScaleSpace access.");
     }
@@ -69,77 +102,68 @@ float accessScaleSpace(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint
         access_x < 0 || access_x >= img.cols) {
         throw std::out_of_range("Keypoint (x,y) coordinates are out of bounds for image access."); 
     }
-    return img.at<float>(access_y, access_x);
+    return sampleLevel(img, access_y, access_x, value_scale);
 }
 
-auto make_dog_accessor = [](const ss::ScaleSpace& ss, const kp::KeyPoint& kp) {
-    return [&ss, kp](int dx, int dy, int ds) -> float {
-        kp::KeyPoint neighbor_kp = kp;
-        neighbor_kp.x += dx;
-        neighbor_kp.y += dy;
-        neighbor_kp.scale_idx += ds;
-
-        // getting specific octave to check scale index bounds
-        if (neighbor_kp.octave_idx < 0 || neighbor_kp.octave_idx >= ss.size()) {
-            return 0.0f; 
-        }
-
-        const ss::Octave& current_octave = ss[neighbor_kp.octave_idx];
-
-        // if the neighbor's scale_idx is valid for the current octave
-        if (neighbor_kp.scale_idx < 0.0f || neighbor_kp.scale_idx >= current_octave.size()) {
-            return 0.0f; 
-        }
+Stencil loadStencil(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint, float value_scale) {
+    Stencil stencil{};
+    if (keypoint.octave_idx < 0 || keypoint.octave_idx >= static_cast<int>(DoG_scale_space.size())) {
+        return stencil;
+    }
+    const ss::Octave& octave = DoG_scale_space[keypoint.octave_idx];
 
-        const cv::Mat& target_img = current_octave[static_cast<int>(std::round(neighbor_kp.scale_idx))];
-        int neighbor_access_x = static_cast<int>(std::round(neighbor_kp.x));
-        int neighbor_access_y = static_cast<int>(std::round(neighbor_kp.y));
+    // Each offset is rounded on its own, exactly as a lookup of the shifted keypoint would be
+    int cols[3], rows[3];
+    for (int d = 0; d < 3; d++) {
+        cols[d] = static_cast<int>(std::round(keypoint.x + (d - 1)));
+        rows[d] = static_cast<int>(std::round(keypoint.y + (d - 1)));
+    }
 
-        if (neighbor_access_y < 0 || neighbor_access_y >= target_img.rows ||
-            neighbor_access_x < 0 || neighbor_access_x >= target_img.cols) {
-            return 0.0f;
+    for (int ds = 0; ds < 3; ds++) {
+        const float scale_idx = keypoint.scale_idx + (ds - 1);
+        if (scale_idx < 0.0f || scale_idx >= octave.size()) continue;
+
+        const cv::Mat& image = octave[static_cast<int>(std::round(scale_idx))];
+        for (int dy = 0; dy < 3; dy++) {
+            if (rows[dy] < 0 || rows[dy] >= image.rows) continue;
+            for (int dx = 0; dx < 3; dx++) {
+                if (cols[dx] < 0 || cols[dx] >= image.cols) continue;
+                stencil[ds][dy][dx] = sampleLevel(image, rows[dy], cols[dx], value_scale);
+            }
         }
+    }
+    return stencil;
+}
 
-        return target_img.at<float>(neighbor_access_y, neighbor_access_x);
-    };
-};
-
-std::vector<float> calculateKeypointGradients(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint){
-    auto dog = make_dog_accessor(DoG_scale_space, keypoint);
-    
-    std::vector<float> gradients(3);
-
-    gradients[0] = 0.5f * (dog(1, 0, 0) - dog(-1, 0, 0));
-    gradients[1] = 0.5f * (dog(0, 1, 0) - dog(0, -1, 0));
-    gradients[2] = 0.5f * (dog(0, 0, 1) - dog(0, 0, -1));
-
-    return gradients;
-};
-
-std::vector<std::vector<float>> calculateKeypointHessian (const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint) {
-    auto dog = make_dog_accessor(DoG_scale_space, keypoint);
-
-    std::vector<float> curvature(3);
+Vec3 stencilGradient(const Stencil& d) {
+    return {0.5f * (d[1][1][2] - d[1][1][0]),
+            0.5f * (d[1][2][1] - d[1][0][1]),
+            0.5f * (d[2][1][1] - d[0][1][1])};
+}
 
+Mat3 stencilHessian(const Stencil& d) {
+    const float centre = d[1][1][1];
+    const float dxx = d[1][1][2] + d[1][1][0] - 2 * centre;
+    const float dyy = d[1][2][1] + d[1][0][1] - 2 * centre;
+    const float dss = d[2][1][1] + d[0][1][1] - 2 * centre;
 
-    curvature[0] = dog(1, 0, 0) + dog(-1, 0, 0) - 2 * dog(0, 0, 0);
-    curvature[1] = dog(0, 1, 0) + dog(0, -1, 0) - 2 * dog(0, 0, 0);
-    curvature[2] = dog(0, 0, 1) + dog(0, 0, -1) - 2 * dog(0, 0, 0);
+    const float dxy = 0.25f * (d[1][2][2] - d[1][0][2] - d[1][2][0] + d[1][0][0]);
+    const float dxs = 0.25f * (d[2][1][2] - d[0][1][2] - d[2][1][0] + d[0][1][0]);
+    const float dys = 0.25f * (d[2][2][1] - d[0][2][1] - d[2][0][1] + d[0][0][1]);
 
-    float dxy = 0.25f * (dog(1, 1, 0) - dog(1, -1, 0) - dog(-1, 1, 0) + dog(-1, -1, 0));
-    float dxs = 0.25f * (dog(1, 0, 1) - dog(1, 0, -1) - dog(-1, 0, 1) + dog(-1, 0, -1));
-    float dys = 0.25f * (dog(0, 1, 1) - dog(0, 1, -1) - dog(0, -1, 1) + dog(0, -1, -1));
+    return {{{dxx, dxy, dxs}, {dxy, dyy, dys}, {dxs, dys, dss}}};
+}
 
-    std::vector<std::vector<float>> hessian = {
-        {curvature[0], dxy, dxs},
-        {dxy, curvature[1], dys},
-        {dxs, dys, curvature[2]}
-    };
+std::vector<float> calculateKeypointGradients(const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint, float value_scale){
+    Vec3 gradients = stencilGradient(loadStencil(DoG_scale_space, keypoint, value_scale));
+    return {gradients[0], gradients[1], gradients[2]};
+}
 
-    return hessian;
-};
+std::vector<std::vector<float>> calculateKeypointHessian (const ss::ScaleSpace& DoG_scale_space, const kp::KeyPoint& keypoint, float value_scale) {
+    return toVector(stencilHessian(loadStencil(DoG_scale_space, keypoint, value_scale)));
+}
 
-bool isOnEdge(const std::vector<std::vector<float>>& hessian, float edge_threshold) {
+bool isOnEdge(const Mat3& hessian, float edge_threshold) {
 
     float dxx = hessian[0][0];
     float dyy = hessian[1][1];
@@ -156,9 +180,17 @@ bool isOnEdge(const std::vector<std::vector<float>>& hessian, float edge_thresho
     float criterion = (trace * trace) / det;
     
     return criterion < (r + 1) * (r + 1) / r;  
-};
+}
 
-void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoint) {
+bool isOnEdge(const std::vector<std::vector<float>>& hessian, float edge_threshold) {
+    return isOnEdge(toMat3(hessian), edge_threshold);
+}
+
+namespace {
+
+// Refines a keypoint whose x and y are already on its octave's sampling grid.
+void refineOctaveKeypoint(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoint, float value_scale,
+                          const cfg::SiftConfig& config) {
 
     const auto& current_octave_DoG = DoG_scale_space[keypoint.octave_idx];
 
@@ -168,19 +200,18 @@ void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoi
         return;
     }
 
-    std::vector<float> gradients = calculateKeypointGradients(DoG_scale_space, keypoint);
-    std::vector<std::vector<float>> hessian = calculateKeypointHessian(DoG_scale_space, keypoint);
+    const Stencil stencil = loadStencil(DoG_scale_space, keypoint, value_scale);
+    const Vec3 gradients = stencilGradient(stencil);
+    const Mat3 hessian = stencilHessian(stencil);
 
-    float det_hessian = calculateDeterminant(hessian);
-    if (std::abs(det_hessian) < 1e-6f) { 
+    if (std::abs(determinant(hessian)) < 1e-6f) { 
         keypoint.x = -1e6; 
         return;
     }
 
-    std::vector<std::vector<float>> Inverse = calculateInverse(hessian);
-
+    const Mat3 Inverse = inverse(hessian);
 
-    std::vector<float> offset(3, 0.0f);
+    Vec3 offset{};
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 3; j++) {
             offset[i] -= Inverse[i][j] * gradients[j];
@@ -188,7 +219,7 @@ void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoi
     }
 
     // Apply offset if it's within limits
-    float offset_threshold_limit = 1.0f;
+    float offset_threshold_limit = config.offset_limit;
     if (std::abs(offset[0]) < offset_threshold_limit && 
         std::abs(offset[1]) < offset_threshold_limit && 
         std::abs(offset[2]) < offset_threshold_limit) {
@@ -218,8 +249,8 @@ void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoi
         }
 
         // Low contrast check 
-        float refined_dog_val = accessScaleSpace(DoG_scale_space, keypoint);
-        float contrast_threshold = 0.04;
+        float refined_dog_val = accessScaleSpace(DoG_scale_space, keypoint, value_scale);
+        float contrast_threshold = config.contrast_threshold;
         if (std::abs(refined_dog_val) < contrast_threshold) { 
              keypoint.x = -1e6; 
              return;
@@ -232,7 +263,7 @@ void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoi
         return;
     }
 
-    float edge_threshold = 10.0f;
+    float edge_threshold = config.edge_threshold;
 
     if (isOnEdge(hessian, edge_threshold)) { // Typically r = 10, so (r+1)^2/r = 121/10 = 12.1
         keypoint.x = -1e6; 
@@ -242,5 +273,53 @@ void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoi
 
 }
 
+namespace {
 
+// Returns false when the keypoint was rejected; its fields then hold the -1e6 sentinel of the single keypoint API.
+bool refineBaseKeypoint(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoint, float value_scale,
+                        const cfg::SiftConfig& config) {
+    // Keypoints carry base-image coordinates (see coarseKeypointDetection); the DoG images of octave o are
+    // sampled 2^o times more coarsely, so refine on that grid and map the result back.
+    const float octave_scale = static_cast<float>(1 << keypoint.octave_idx);
 
+    kp::KeyPoint local = keypoint;
+    local.x /= octave_scale;
+    local.y /= octave_scale;
+
+    refineOctaveKeypoint(DoG_scale_space, local, value_scale, config);
+
+    keypoint.x = local.x == -1e6 ? local.x : local.x * octave_scale;
+    keypoint.y = local.y == -1e6 ? local.y : local.y * octave_scale;
+    keypoint.scale_idx = local.scale_idx;
+    return local.x != -1e6 && local.y != -1e6;
+}
+
+}
+
+void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPoint& keypoint, float value_scale, const cfg::SiftConfig& config) {
+    refineBaseKeypoint(DoG_scale_space, keypoint, value_scale, config);
+}
+
+void refineKeypoints(const ss::Pyramid& DoG_pyramid, kp::KeyPoint& keypoint, const cfg::SiftConfig& config) {
+    refineKeypoints(DoG_pyramid.scaleSpace(), keypoint, DoG_pyramid.valueScale(), config);
+}
+
+void refineKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPointSet& keypoints, float value_scale,
+                     const cfg::SiftConfig& config) {
+    for (size_t i = 0; i < keypoints.size(); i++) {
+        if (!keypoints.isKept(i)) continue;
+        kp::KeyPoint keypoint = keypoints[i];
+        if (refineBaseKeypoint(DoG_scale_space, keypoint, value_scale, config)) {
+            keypoints.set(i, keypoint);
+        } else {
+            keypoints.reject(i);
+        }
+    }
+    keypoints.compact();
+}
+
+void refineKeypoints(const ss::Pyramid& DoG_pyramid, kp::KeyPointSet& keypoints, const cfg::SiftConfig& config) {
+    refineKeypoints(DoG_pyramid.scaleSpace(), keypoints, DoG_pyramid.valueScale(), config);
+}
+
+}
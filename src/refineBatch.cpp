@@ -0,0 +1,244 @@
+#include <iostream>
+#include <array>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "refine.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace refine {
+
+namespace {
+
+// One float per keypoint of a batch. Only the handful of operations the solve needs; masks are lane
+// values with all bits set (vector paths) or 1.0f / 0.0f (scalar fallback), read back through bits().
+#if defined(__AVX2__) && defined(__FMA__)
+struct Lanes {
+    __m256 v;
+    static Lanes load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static Lanes all(float x) { return {_mm256_set1_ps(x)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    int bits() const { return _mm256_movemask_ps(v); }
+};
+inline Lanes operator+(Lanes a, Lanes b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline Lanes operator-(Lanes a, Lanes b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline Lanes operator*(Lanes a, Lanes b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline Lanes operator/(Lanes a, Lanes b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline Lanes operator<(Lanes a, Lanes b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline Lanes operator>=(Lanes a, Lanes b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+inline Lanes operator&(Lanes a, Lanes b) { return {_mm256_and_ps(a.v, b.v)}; }
+inline Lanes andNot(Lanes a, Lanes b) { return {_mm256_andnot_ps(b.v, a.v)}; }
+inline Lanes abs(Lanes a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+#elif defined(__ARM_NEON)
+struct Lanes {
+    float32x4_t lo, hi;
+    static Lanes load(const float* p) { return {vld1q_f32(p), vld1q_f32(p + 4)}; }
+    static Lanes all(float x) { return {vdupq_n_f32(x), vdupq_n_f32(x)}; }
+    void store(float* p) const { vst1q_f32(p, lo); vst1q_f32(p + 4, hi); }
+    int bits() const {
+        uint32_t lanes[8];
+        vst1q_u32(lanes, vreinterpretq_u32_f32(lo));
+        vst1q_u32(lanes + 4, vreinterpretq_u32_f32(hi));
+        int result = 0;
+        for (int lane = 0; lane < 8; lane++) result |= (lanes[lane] >> 31) << lane;
+        return result;
+    }
+};
+inline Lanes operator+(Lanes a, Lanes b) { return {vaddq_f32(a.lo, b.lo), vaddq_f32(a.hi, b.hi)}; }
+inline Lanes operator-(Lanes a, Lanes b) { return {vsubq_f32(a.lo, b.lo), vsubq_f32(a.hi, b.hi)}; }
+inline Lanes operator*(Lanes a, Lanes b) { return {vmulq_f32(a.lo, b.lo), vmulq_f32(a.hi, b.hi)}; }
+inline Lanes operator/(Lanes a, Lanes b) { return {vdivq_f32(a.lo, b.lo), vdivq_f32(a.hi, b.hi)}; }
+inline Lanes operator<(Lanes a, Lanes b) {
+    return {vreinterpretq_f32_u32(vcltq_f32(a.lo, b.lo)), vreinterpretq_f32_u32(vcltq_f32(a.hi, b.hi))};
+}
+inline Lanes operator>=(Lanes a, Lanes b) {
+    return {vreinterpretq_f32_u32(vcgeq_f32(a.lo, b.lo)), vreinterpretq_f32_u32(vcgeq_f32(a.hi, b.hi))};
+}
+inline Lanes operator&(Lanes a, Lanes b) {
+    return {vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.lo), vreinterpretq_u32_f32(b.lo))),
+            vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.hi), vreinterpretq_u32_f32(b.hi)))};
+}
+inline Lanes andNot(Lanes a, Lanes b) {
+    return {vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(a.lo), vreinterpretq_u32_f32(b.lo))),
+            vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(a.hi), vreinterpretq_u32_f32(b.hi)))};
+}
+inline Lanes abs(Lanes a) { return {vabsq_f32(a.lo), vabsq_f32(a.hi)}; }
+#else
+struct Lanes {
+    std::array<float, 8> v;
+    static Lanes load(const float* p) { Lanes r; for (int l = 0; l < 8; l++) r.v[l] = p[l]; return r; }
+    static Lanes all(float x) { Lanes r; r.v.fill(x); return r; }
+    void store(float* p) const { for (int l = 0; l < 8; l++) p[l] = v[l]; }
+    int bits() const { int result = 0; for (int l = 0; l < 8; l++) result |= (v[l] != 0.0f) << l; return result; }
+};
+template <typename Op>
+inline Lanes laneWise(Lanes a, Lanes b, Op op) { Lanes r; for (int l = 0; l < 8; l++) r.v[l] = op(a.v[l], b.v[l]); return r; }
+inline Lanes operator+(Lanes a, Lanes b) { return laneWise(a, b, [](float x, float y) { return x + y; }); }
+inline Lanes operator-(Lanes a, Lanes b) { return laneWise(a, b, [](float x, float y) { return x - y; }); }
+inline Lanes operator*(Lanes a, Lanes b) { return laneWise(a, b, [](float x, float y) { return x * y; }); }
+inline Lanes operator/(Lanes a, Lanes b) { return laneWise(a, b, [](float x, float y) { return x / y; }); }
+inline Lanes operator<(Lanes a, Lanes b) { return laneWise(a, b, [](float x, float y) { return x < y ? 1.0f : 0.0f; }); }
+inline Lanes operator>=(Lanes a, Lanes b) { return laneWise(a, b, [](float x, float y) { return x >= y ? 1.0f : 0.0f; }); }
+inline Lanes operator&(Lanes a, Lanes b) { return laneWise(a, b, [](float x, float y) { return x != 0.0f && y != 0.0f ? 1.0f : 0.0f; }); }
+inline Lanes andNot(Lanes a, Lanes b) { return laneWise(a, b, [](float x, float y) { return x != 0.0f && y == 0.0f ? 1.0f : 0.0f; }); }
+inline Lanes abs(Lanes a) { Lanes r; for (int l = 0; l < 8; l++) r.v[l] = std::abs(a.v[l]); return r; }
+#endif
+
+// A batch transposed to one array per quantity, lane l holding keypoint l
+struct Batch {
+    float stencil[27][kRefineBatchSize];
+    float x[kRefineBatchSize], y[kRefineBatchSize], scale_idx[kRefineBatchSize];
+    float cols[kRefineBatchSize], rows[kRefineBatchSize], levels[kRefineBatchSize];
+    int index[kRefineBatchSize];
+    int count;
+};
+
+// Same decisions as refineKeypoints, lane by lane: the gradient, Hessian, Cramer solve (adjugate over
+// determinant), offset, bounds and edge tests run in vector lanes; the refined contrast sample is the one
+// gather left scalar. Rejected lanes are cleared in the set's mask.
+void refineBatch(const ss::ScaleSpace& DoG_scale_space, Batch& batch, int valid_bits, kp::KeyPointSet& keypoints, float value_scale,
+                 const cfg::SiftConfig& config) {
+    auto s = [&](int ds, int dy, int dx) { return Lanes::load(batch.stencil[(ds * 3 + dy) * 3 + dx]); };
+
+    const Lanes centre = s(1, 1, 1);
+    const Lanes two = Lanes::all(2.0f), half = Lanes::all(0.5f), quarter = Lanes::all(0.25f);
+
+    const Lanes g[3] = {half * (s(1, 1, 2) - s(1, 1, 0)), half * (s(1, 2, 1) - s(1, 0, 1)), half * (s(2, 1, 1) - s(0, 1, 1))};
+
+    const Lanes dxx = s(1, 1, 2) + s(1, 1, 0) - two * centre;
+    const Lanes dyy = s(1, 2, 1) + s(1, 0, 1) - two * centre;
+    const Lanes dss = s(2, 1, 1) + s(0, 1, 1) - two * centre;
+    const Lanes dxy = quarter * (s(1, 2, 2) - s(1, 0, 2) - s(1, 2, 0) + s(1, 0, 0));
+    const Lanes dxs = quarter * (s(2, 1, 2) - s(0, 1, 2) - s(2, 1, 0) + s(0, 1, 0));
+    const Lanes dys = quarter * (s(2, 2, 1) - s(0, 2, 1) - s(2, 0, 1) + s(0, 0, 1));
+    const Lanes H[3][3] = {{dxx, dxy, dxs}, {dxy, dyy, dys}, {dxs, dys, dss}};
+
+    Lanes adj[3][3];
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            adj[col][row] = H[(row + 1) % 3][(col + 1) % 3] * H[(row + 2) % 3][(col + 2) % 3]
+                          - H[(row + 1) % 3][(col + 2) % 3] * H[(row + 2) % 3][(col + 1) % 3];
+        }
+    }
+    const Lanes det = H[0][0] * adj[0][0] + H[0][1] * adj[1][0] + H[0][2] * adj[2][0];
+    Lanes keep = abs(det) >= Lanes::all(1e-6f);
+
+    const Lanes limit = Lanes::all(config.offset_limit);
+    Lanes offset[3];
+    for (int i = 0; i < 3; i++) {
+        offset[i] = Lanes::all(0.0f) - (adj[i][0] / det) * g[0] - (adj[i][1] / det) * g[1] - (adj[i][2] / det) * g[2];
+        keep = keep & (abs(offset[i]) < limit);
+    }
+
+    const Lanes x = Lanes::load(batch.x) + offset[0];
+    const Lanes y = Lanes::load(batch.y) + offset[1];
+    const Lanes scale_idx = Lanes::load(batch.scale_idx) + offset[2];
+    const Lanes zero = Lanes::all(0.0f), one = Lanes::all(1.0f);
+    keep = keep & (x >= zero) & (x < Lanes::load(batch.cols) - one) & (y >= zero) & (y < Lanes::load(batch.rows) - one) &
+           (scale_idx >= zero) & (scale_idx < Lanes::load(batch.levels) - one);
+
+    // Edge test on the 2x2 spatial Hessian, as isOnEdge
+    const Lanes det2 = dxx * dyy - dxy * dxy;
+    const Lanes trace = dxx + dyy;
+    const float r = config.edge_threshold;
+    const Lanes on_edge = (abs(det2) >= Lanes::all(1e-6f)) & ((trace * trace) / det2 < Lanes::all((r + 1) * (r + 1) / r));
+    keep = andNot(keep, on_edge);
+
+    float refined_x[kRefineBatchSize], refined_y[kRefineBatchSize], refined_s[kRefineBatchSize];
+    x.store(refined_x);
+    y.store(refined_y);
+    scale_idx.store(refined_s);
+
+    const int keep_bits = keep.bits() & valid_bits;
+    for (int lane = 0; lane < batch.count; lane++) {
+        const int i = batch.index[lane];
+        if (!(keep_bits >> lane & 1)) {
+            keypoints.reject(i);
+            continue;
+        }
+
+        const int octave_idx = keypoints.octaveIdx()[i];
+        kp::KeyPoint local{refined_x[lane], refined_y[lane], refined_s[lane], octave_idx, keypoints.DoGValue()[i]};
+        if (std::abs(accessScaleSpace(DoG_scale_space, local, value_scale)) < config.contrast_threshold) {
+            keypoints.reject(i);
+            continue;
+        }
+
+        const float octave_scale = static_cast<float>(1 << octave_idx);
+        keypoints.x()[i] = local.x * octave_scale;
+        keypoints.y()[i] = local.y * octave_scale;
+        keypoints.scaleIdx()[i] = local.scale_idx;
+    }
+}
+
+}
+
+void refineKeypointsBatch(const ss::ScaleSpace& DoG_scale_space, kp::KeyPointSet& keypoints, float value_scale,
+                          const cfg::SiftConfig& config) {
+    Batch batch;
+    batch.count = 0;
+    int valid_bits = 0;
+
+    for (size_t i = 0; i < keypoints.size(); i++) {
+        if (!keypoints.isKept(i)) continue;
+
+        const int octave_idx = keypoints.octaveIdx()[i];
+        const ss::Octave& octave = DoG_scale_space[octave_idx];
+        const float octave_scale = static_cast<float>(1 << octave_idx);
+        const kp::KeyPoint local{keypoints.x()[i] / octave_scale, keypoints.y()[i] / octave_scale, keypoints.scaleIdx()[i],
+                                 octave_idx, keypoints.DoGValue()[i]};
+
+        const int lane = batch.count++;
+        batch.index[lane] = static_cast<int>(i);
+        batch.x[lane] = local.x;
+        batch.y[lane] = local.y;
+        batch.scale_idx[lane] = local.scale_idx;
+        batch.cols[lane] = static_cast<float>(octave[0].cols);
+        batch.rows[lane] = static_cast<float>(octave[0].rows);
+        batch.levels[lane] = static_cast<float>(octave.size());
+
+        // Keypoints at a scale boundary have no full 3x3x3 neighbourhood; their lane computes on zeros
+        const bool interior = local.scale_idx > 0 && local.scale_idx < octave.size() - 1;
+        const Stencil stencil = interior ? loadStencil(DoG_scale_space, local, value_scale) : Stencil{};
+        for (int ds = 0; ds < 3; ds++) {
+            for (int dy = 0; dy < 3; dy++) {
+                for (int dx = 0; dx < 3; dx++) {
+                    batch.stencil[(ds * 3 + dy) * 3 + dx][lane] = stencil[ds][dy][dx];
+                }
+            }
+        }
+        valid_bits |= interior << lane;
+
+        if (batch.count == kRefineBatchSize) {
+            refineBatch(DoG_scale_space, batch, valid_bits, keypoints, value_scale, config);
+            batch.count = 0;
+            valid_bits = 0;
+        }
+    }
+
+    if (batch.count > 0) {
+        // Unused lanes repeat lane 0 so they stay finite; they are never written back
+        for (int lane = batch.count; lane < kRefineBatchSize; lane++) {
+            for (auto& sample : batch.stencil) sample[lane] = sample[0];
+            batch.x[lane] = batch.x[0];
+            batch.y[lane] = batch.y[0];
+            batch.scale_idx[lane] = batch.scale_idx[0];
+            batch.cols[lane] = batch.cols[0];
+            batch.rows[lane] = batch.rows[0];
+            batch.levels[lane] = batch.levels[0];
+        }
+        refineBatch(DoG_scale_space, batch, valid_bits, keypoints, value_scale, config);
+    }
+
+    keypoints.compact();
+}
+
+void refineKeypointsBatch(const ss::Pyramid& DoG_pyramid, kp::KeyPointSet& keypoints, const cfg::SiftConfig& config) {
+    refineKeypointsBatch(DoG_pyramid.scaleSpace(), keypoints, DoG_pyramid.valueScale(), config);
+}
+
+}
@@ -0,0 +1,155 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "refine.hpp"
+
+namespace refine {
+
+namespace {
+
+uint64_t sampleKey(int octave_idx, int level, int row, int col) {
+    return (static_cast<uint64_t>(octave_idx) << 56) | (static_cast<uint64_t>(level) << 48) |
+           (static_cast<uint64_t>(row) << 24) | static_cast<uint64_t>(col);
+}
+
+// Direct-mapped cache of the stencils around integer sample positions. Candidates of one octave arrive in
+// scan order, so a keypoint stepping to a neighbour often lands on a position a nearby candidate loaded.
+class StencilCache {
+  public:
+    const Stencil& get(const ss::ScaleSpace& DoG_scale_space, int octave_idx, int level, int row, int col, float value_scale,
+                       LocalizationStats& stats) {
+        const uint64_t key = sampleKey(octave_idx, level, row, col);
+        Entry& entry = entries_[(key * 0x9E3779B97F4A7C15ull) >> (64 - kLogEntries)];
+        if (entry.key == key) {
+            stats.cache_hits++;
+            return entry.stencil;
+        }
+        stats.stencil_loads++;
+        entry.key = key;
+        entry.stencil = loadStencil(DoG_scale_space, {static_cast<float>(col), static_cast<float>(row), static_cast<float>(level), octave_idx, 0.0f},
+                                    value_scale);
+        return entry.stencil;
+    }
+
+  private:
+    static constexpr int kLogEntries = 6;
+    struct Entry {
+        uint64_t key = ~0ull;
+        Stencil stencil;
+    };
+    std::array<Entry, 1 << kLogEntries> entries_;
+};
+
+// Lowe's edge test: principal curvature ratio below edge_threshold, and curvatures of the same sign.
+bool passesEdgeTest(const Mat3& hessian, float edge_threshold) {
+    const float trace = hessian[0][0] + hessian[1][1];
+    const float det = hessian[0][0] * hessian[1][1] - hessian[0][1] * hessian[0][1];
+    return det > 0 && trace * trace * edge_threshold < (edge_threshold + 1) * (edge_threshold + 1) * det;
+}
+
+}
+
+LocalizationOptions localizationOptions(const cfg::SiftConfig& config) {
+    LocalizationOptions options;
+    options.contrast_threshold = config.contrast_threshold;
+    options.edge_threshold = config.edge_threshold;
+    return options;
+}
+
+void localizeKeypoints(const ss::ScaleSpace& DoG_scale_space, kp::KeyPointSet& keypoints, const LocalizationOptions& options,
+                       float value_scale, LocalizationStats* stats) {
+    if (options.max_iterations <= 0) {
+        throw std::invalid_argument("Localization needs at least one iteration.");
+    }
+
+    LocalizationStats local_stats;
+    StencilCache cache;
+    std::vector<std::pair<uint64_t, size_t>> converged;
+    converged.reserve(keypoints.size());
+
+    for (size_t i = 0; i < keypoints.size(); i++) {
+        if (!keypoints.isKept(i)) continue;
+
+        const int octave_idx = keypoints.octaveIdx()[i];
+        const ss::Octave& octave = DoG_scale_space[octave_idx];
+        const int levels = static_cast<int>(octave.size());
+        const int rows = octave[0].rows, cols = octave[0].cols;
+        const float octave_scale = static_cast<float>(1 << octave_idx);
+
+        int col = static_cast<int>(std::round(keypoints.x()[i] / octave_scale));
+        int row = static_cast<int>(std::round(keypoints.y()[i] / octave_scale));
+        int level = static_cast<int>(std::round(keypoints.scaleIdx()[i]));
+
+        bool localized = false;
+        Vec3 offset{}, gradient{};
+        Mat3 hessian{};
+        const Stencil* stencil = nullptr;
+        for (int iteration = 0; iteration < options.max_iterations; iteration++) {
+            if (level < 1 || level > levels - 2 || row < 1 || row > rows - 2 || col < 1 || col > cols - 2) break;
+
+            stencil = &cache.get(DoG_scale_space, octave_idx, level, row, col, value_scale, local_stats);
+            gradient = stencilGradient(*stencil);
+            hessian = stencilHessian(*stencil);
+            if (std::abs(determinant(hessian)) < 1e-6f) break;
+
+            const Mat3 inv = inverse(hessian);
+            for (int d = 0; d < 3; d++) {
+                offset[d] = -(inv[d][0] * gradient[0] + inv[d][1] * gradient[1] + inv[d][2] * gradient[2]);
+            }
+
+            if (std::abs(offset[0]) < 0.5f && std::abs(offset[1]) < 0.5f && std::abs(offset[2]) < 0.5f) {
+                localized = true;
+                break;
+            }
+            // A near-singular fit can put the extremum arbitrarily far away; reject it before rounding, where an
+            // offset outside int range would be undefined (cf. OpenCV's INT_MAX / 3 check)
+            if (!(std::abs(offset[0]) <= cols && std::abs(offset[1]) <= rows && std::abs(offset[2]) <= levels)) break;
+            if (iteration + 1 == options.max_iterations) break;
+
+            // The extremum is nearer another sample: move there and fit again
+            col += static_cast<int>(std::round(offset[0]));
+            row += static_cast<int>(std::round(offset[1]));
+            level += static_cast<int>(std::round(offset[2]));
+            local_stats.moves++;
+        }
+
+        if (!localized) {
+            keypoints.reject(i);
+            continue;
+        }
+
+        const float value = (*stencil)[1][1][1] + 0.5f * (gradient[0] * offset[0] + gradient[1] * offset[1] + gradient[2] * offset[2]);
+        if (std::abs(value) < options.contrast_threshold || !passesEdgeTest(hessian, options.edge_threshold)) {
+            keypoints.reject(i);
+            continue;
+        }
+
+        keypoints.set(i, {(col + offset[0]) * octave_scale, (row + offset[1]) * octave_scale, level + offset[2], octave_idx, value});
+        converged.push_back({sampleKey(octave_idx, level, row, col), i});
+    }
+
+    // Candidates that converged on the same sample found the same extremum; the first one in input order stays
+    if (options.remove_duplicates) {
+        std::sort(converged.begin(), converged.end());
+        for (size_t j = 1; j < converged.size(); j++) {
+            if (converged[j].first == converged[j - 1].first) {
+                keypoints.reject(converged[j].second);
+                local_stats.duplicates++;
+            }
+        }
+    }
+
+    keypoints.compact();
+    if (stats) *stats = local_stats;
+}
+
+void localizeKeypoints(const ss::Pyramid& DoG_pyramid, kp::KeyPointSet& keypoints, const LocalizationOptions& options,
+                       LocalizationStats* stats) {
+    localizeKeypoints(DoG_pyramid.scaleSpace(), keypoints, options, DoG_pyramid.valueScale(), stats);
+}
+
+}
@@ -2,7 +2,9 @@
 #include <vector>
 #include <stdexcept>
 #include <opencv2/opencv.hpp>
+#include "blur.hpp"
 #include "scaleSpace.hpp"
+#include "pyramid.hpp"
 
 namespace ss {
   
@@ -20,17 +22,60 @@ float computeDeltaSigma(float prev_sigma, float curr_sigma) {
     return std::sqrt(curr_sigma * curr_sigma - prev_sigma * prev_sigma); 
 }
 
-void prepareOctave(Octave& octave, cv::Mat base_image, float initial_scale, int scalesPerOctave) {
+blur::Backend selectBlurBackend(const ScaleSpaceOptions& options, float sigma) {
+    if (sigma > options.recursive_sigma_cutoff && sigma >= blur::kMinRecursiveSigma) {
+        return blur::Backend::Recursive;
+    }
+    return options.blur_backend;
+}
 
-    octave.resize(scalesPerOctave + 2);
+namespace {
+
+void blurLevelFromBase(Octave& octave, int level, float initial_scale, int scalesPerOctave, const ScaleSpaceOptions& options) {
+    float delta_sigma = computeDeltaSigma(computeSigmaForLevel(initial_scale, 0, scalesPerOctave),
+                                          computeSigmaForLevel(initial_scale, level, scalesPerOctave));
+    blur::gaussianBlur(octave[0], octave[level], delta_sigma, selectBlurBackend(options, delta_sigma));
+}
+
+void downsampleOctaveSeed(const Octave& octave, cv::Mat& next_base) {
+    const cv::Mat& downsampling_image = octave.back();
+    if (downsampling_image.empty() || downsampling_image.cols == 0 || downsampling_image.rows == 0) {
+        throw std::logic_error("Downsampling image is invalid (empty or zero-size) before resize");
+    }
+    cv::resize(downsampling_image, next_base, cv::Size(), 0.5, 0.5);
+}
+
+void validateScaleSpaceArguments(const cv::Mat& base_image, int numOctaves, int scalesPerOctave, float initial_scale) {
+    if (base_image.empty() || base_image.type() != CV_32F) {
+        throw std::invalid_argument("Base image must be non-empty and of type CV_32F.");
+    }
+
+    if (numOctaves <= 0 || scalesPerOctave <= 0) {
+        throw std::invalid_argument("Number of octaves and scales per octave must be positive.");
+    } 
+
+    if(initial_scale <= 0){
+      throw std::invalid_argument("Initial Scale must be greater than 0.");
+    }
+}
+
+// Fills levels 1.. of an octave whose base (level 0) is already in place.
+void fillOctave(Octave& octave, float initial_scale, int scalesPerOctave, const ScaleSpaceOptions& options) {
+
+    if (options.mode == ConstructionMode::DirectFromBase) {
+        cv::parallel_for_(cv::Range(1, scalesPerOctave + 2), [&](const cv::Range& range) {
+            for (int image_idx = range.start; image_idx < range.end; image_idx++) {
+                blurLevelFromBase(octave, image_idx, initial_scale, scalesPerOctave, options);
+            }
+        });
+        return;
+    }
 
     std::vector<float> sigmas(scalesPerOctave + 2);
     for (int i = 0; i < scalesPerOctave + 2; ++i) {
         sigmas[i] = computeSigmaForLevel(initial_scale, i, scalesPerOctave);
     }
 
-    octave[0] = base_image;
-
     for (int image_idx = 1; image_idx < scalesPerOctave + 2; image_idx++) {
 
         if(octave[image_idx - 1].empty()){
@@ -38,42 +83,134 @@ void prepareOctave(Octave& octave, cv::Mat base_image, float initial_scale, int
         }
 
         float delta_sigma = computeDeltaSigma(sigmas[image_idx - 1], sigmas[image_idx]);
-        cv::GaussianBlur(octave[image_idx - 1], octave[image_idx], cv::Size(0, 0), delta_sigma, delta_sigma, cv::BORDER_REFLECT101);
+        blur::gaussianBlur(octave[image_idx - 1], octave[image_idx], delta_sigma, selectBlurBackend(options, delta_sigma));
 
     }
 }
 
-void prepareScaleSpace(ScaleSpace& scaleSpace, const cv::Mat& base_image, int numOctaves, int scalesPerOctave, float initial_scale) {
+// Only base -> last level -> next base is a true dependency chain. The last level of each octave is
+// blurred first, then the remaining levels and the seeding of the next octave run as one parallel batch.
+void fillScaleSpaceDirect(ScaleSpace& scaleSpace, int scalesPerOctave, float initial_scale, const ScaleSpaceOptions& options) {
+    const int numOctaves = scaleSpace.size();
+    const int last_level = scalesPerOctave + 1;
+
+    blurLevelFromBase(scaleSpace[0], last_level, initial_scale, scalesPerOctave, options);
+
+    for (int octave_idx = 0; octave_idx < numOctaves; octave_idx++) {
+        Octave& octave = scaleSpace[octave_idx];
+        const bool seeds_next = octave_idx + 1 < numOctaves;
+        const int num_tasks = scalesPerOctave + (seeds_next ? 1 : 0);
+
+        cv::parallel_for_(cv::Range(0, num_tasks), [&](const cv::Range& range) {
+            for (int task = range.start; task < range.end; task++) {
+                if (task < scalesPerOctave) {
+                    blurLevelFromBase(octave, task + 1, initial_scale, scalesPerOctave, options);
+                } else {
+                    Octave& next_octave = scaleSpace[octave_idx + 1];
+                    downsampleOctaveSeed(octave, next_octave[0]);
+                    blurLevelFromBase(next_octave, last_level, initial_scale, scalesPerOctave, options);
+                }
+            }
+        });
+    }
+}
 
-    if (base_image.empty() || base_image.type() != CV_32F) {
-        throw std::invalid_argument("Base image must be non-empty and of type CV_32F.");
+// Fills every level of a scale space whose structure is sized and whose first base image is in place.
+// Existing Mats of the right size are written in place, which is what keeps Pyramid headers valid.
+void fillScaleSpace(ScaleSpace& scaleSpace, int scalesPerOctave, float initial_scale, const ScaleSpaceOptions& options) {
+    if (options.mode == ConstructionMode::DirectFromBase) {
+        fillScaleSpaceDirect(scaleSpace, scalesPerOctave, initial_scale, options);
+        return;
     }
 
-    if (numOctaves <= 0 || scalesPerOctave <= 0) {
-        throw std::invalid_argument("Number of octaves and scales per octave must be positive.");
-    } 
+    fillOctave(scaleSpace[0], initial_scale, scalesPerOctave, options);
 
-    if(initial_scale <= 0){
-      throw std::invalid_argument("Initial Scale must be greater than 0.");
+    for (size_t octave = 1; octave < scaleSpace.size(); octave++) {
+        downsampleOctaveSeed(scaleSpace[octave - 1], scaleSpace[octave][0]);
+        fillOctave(scaleSpace[octave], initial_scale, scalesPerOctave, options);
     }
+}
+
+// Only one float octave is alive at a time; each finished level is quantized into the CV_16S pyramid and
+// the float last level seeds the next octave, so quantization error does not compound across octaves.
+void prepareFixedPointScaleSpace(Pyramid& pyramid, const cv::Mat& base_image, int numOctaves, int scalesPerOctave,
+                                 float initial_scale, const ScaleSpaceOptions& options) {
+
+    pyramid.allocate(base_image.size(), numOctaves, scalesPerOctave + 2, CV_16S);
+
+    double max_magnitude = cv::norm(base_image, cv::NORM_INF);
+    pyramid.setValueScale(max_magnitude > 0 ? static_cast<float>(kFixedPointRange / max_magnitude) : 1.0f);
+
+    Octave octave(scalesPerOctave + 2);
+    octave[0] = base_image;
+
+    for (int octave_idx = 0; octave_idx < numOctaves; octave_idx++) {
+        if (octave_idx > 0) {
+            cv::Mat next_base;
+            downsampleOctaveSeed(octave, next_base);
+            octave.assign(scalesPerOctave + 2, cv::Mat());
+            octave[0] = next_base;
+        }
+
+        fillOctave(octave, initial_scale, scalesPerOctave, options);
+
+        for (int level = 0; level < scalesPerOctave + 2; level++) {
+            quantizeLevel(viewOf<const float>(octave[level]), pyramid.view<short>(octave_idx, level), pyramid.valueScale());
+        }
+    }
+}
+
+}
+
+void prepareOctave(Octave& octave, cv::Mat base_image, float initial_scale, int scalesPerOctave,
+                   const ScaleSpaceOptions& options) {
+
+    octave.resize(scalesPerOctave + 2);
+    octave[0] = base_image;
+    fillOctave(octave, initial_scale, scalesPerOctave, options);
+}
+
+void prepareScaleSpace(ScaleSpace& scaleSpace, const cv::Mat& base_image, int numOctaves, int scalesPerOctave, float initial_scale,
+                       const ScaleSpaceOptions& options) {
+
+    validateScaleSpaceArguments(base_image, numOctaves, scalesPerOctave, initial_scale);
     
     scaleSpace.resize(numOctaves);
+    for (Octave& octave : scaleSpace) {
+        octave.resize(scalesPerOctave + 2);
+    }
 
-    prepareOctave(scaleSpace[0], base_image.clone(), initial_scale, scalesPerOctave);
+    scaleSpace[0][0] = base_image.clone();
+    fillScaleSpace(scaleSpace, scalesPerOctave, initial_scale, options);
+}
 
-    for (int octave = 1; octave < numOctaves; octave++) {
+void prepareScaleSpace(Pyramid& pyramid, const cv::Mat& base_image, int numOctaves, int scalesPerOctave, float initial_scale,
+                       const ScaleSpaceOptions& options) {
 
-        cv::Mat base_image_downsampled;
-        cv::Mat downsampling_image = scaleSpace[octave - 1].back();
+    validateScaleSpaceArguments(base_image, numOctaves, scalesPerOctave, initial_scale);
 
-          if (downsampling_image.empty() || downsampling_image.cols == 0 || downsampling_image.rows == 0) {
-              throw std::logic_error("Downsampling image is invalid (empty or zero-size) before resize");
-          }
-        cv::resize(downsampling_image, base_image_downsampled, cv::Size(), 0.5, 0.5);
-          
-        prepareOctave(scaleSpace[octave], base_image_downsampled, initial_scale, scalesPerOctave);
+    if (options.storage_depth == CV_16S) {
+        prepareFixedPointScaleSpace(pyramid, base_image, numOctaves, scalesPerOctave, initial_scale, options);
+        return;
     }
-}
+    if (options.storage_depth != CV_32F) {
+        throw std::invalid_argument("Pyramid storage depth must be CV_32F or CV_16S.");
+    }
+
+    pyramid.allocate(base_image.size(), numOctaves, scalesPerOctave + 2, CV_32F);
+    pyramid.setValueScale(1.0f);
 
+    ScaleSpace& levels = pyramid.scaleSpace();
+    base_image.copyTo(levels[0][0]);
+    fillScaleSpace(levels, scalesPerOctave, initial_scale, options);
+
+    for (int octave = 0; octave < numOctaves; octave++) {
+        for (int level = 0; level < scalesPerOctave + 2; level++) {
+            if (levels[octave][level].data != reinterpret_cast<const uchar*>(pyramid.view(octave, level).data)) {
+                throw std::logic_error("Pyramid level was reallocated instead of written in place.");
+            }
+        }
+    }
 }
 
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "scaleSpace.hpp"
+#include "scaleSpaceBuilder.hpp"
+
+namespace ss {
+
+// 2x2 box average, which is what cv::resize(..., 0.5, 0.5) computes; odd trailing rows and columns are clamped.
+void downsampleByTwo(LevelView<const float> src, LevelView<float> dst) {
+    for (int row = 0; row < dst.rows; row++) {
+        const float* top = src.row(std::min(2 * row, src.rows - 1));
+        const float* bottom = src.row(std::min(2 * row + 1, src.rows - 1));
+        float* out = dst.row(row);
+        for (int col = 0; col < dst.cols; col++) {
+            int left = std::min(2 * col, src.cols - 1);
+            int right = std::min(2 * col + 1, src.cols - 1);
+            out[col] = 0.25f * ((top[left] + top[right]) + (bottom[left] + bottom[right]));
+        }
+    }
+}
+
+ScaleSpaceBuilder::ScaleSpaceBuilder(cv::Size frame_size, int numOctaves, int scalesPerOctave, float initial_scale,
+                                     bool keep_gaussian_pyramid)
+    : frame_size_(frame_size), num_octaves_(numOctaves), scales_per_octave_(scalesPerOctave), initial_scale_(initial_scale),
+      keep_gaussian_pyramid_(keep_gaussian_pyramid) {
+
+    if (numOctaves <= 0 || scalesPerOctave <= 0) {
+        throw std::invalid_argument("Number of octaves and scales per octave must be positive.");
+    }
+    if (initial_scale <= 0) {
+        throw std::invalid_argument("Initial Scale must be greater than 0.");
+    }
+
+    DoG_pyramid_.allocate(frame_size, numOctaves, scalesPerOctave + 1, CV_32F);
+
+    if (keep_gaussian_pyramid) {
+        gaussian_pyramid_.allocate(frame_size, numOctaves, scalesPerOctave + 2, CV_32F);
+    } else {
+        scratch_.allocate(frame_size, 1, 2, CV_32F);
+        scratch_headers_.resize(numOctaves);
+        base_slot_.resize(numOctaves);
+
+        for (int octave = 0; octave < numOctaves; octave++) {
+            cv::Size size = DoG_pyramid_.octaveSize(octave);
+            for (int slot = 0; slot < 2; slot++) {
+                LevelView<float> buffer = scratch_.view(0, slot);
+                scratch_headers_[octave][slot] = cv::Mat(size, CV_32F, buffer.data, buffer.stride * sizeof(float));
+            }
+            // The next base must not overwrite the last level it is downsampled from
+            int previous_last_slot = octave == 0 ? 1 : (base_slot_[octave - 1] + scalesPerOctave + 1) % 2;
+            base_slot_[octave] = 1 - previous_last_slot;
+        }
+    }
+
+    int max_radius = 0;
+    level_kernels_.assign(scalesPerOctave + 2, nullptr);
+    for (int level = 1; level < scalesPerOctave + 2; level++) {
+        float delta_sigma = computeDeltaSigma(computeSigmaForLevel(initial_scale, level - 1, scalesPerOctave),
+                                              computeSigmaForLevel(initial_scale, level, scalesPerOctave));
+        level_kernels_[level] = &blur::getCachedKernel(delta_sigma);
+        max_radius = std::max(max_radius, level_kernels_[level]->radius);
+    }
+
+    row_buffer_.resize(frame_size.width + 2 * max_radius);
+}
+
+void ScaleSpaceBuilder::build(const cv::Mat& frame) {
+    if (frame.empty() || frame.type() != CV_32F || frame.size() != frame_size_) {
+        throw std::invalid_argument("Frame must be CV_32F and match the builder frame size.");
+    }
+
+    cv::Mat& base = gaussianLevel(0, 0);
+    for (int row = 0; row < base.rows; row++) {
+        std::memcpy(base.ptr<float>(row), frame.ptr<float>(row), base.cols * sizeof(float));
+    }
+
+    ScaleSpace& DoG_levels = DoG_pyramid_.scaleSpace();
+
+    for (int octave = 0; octave < num_octaves_; octave++) {
+        if (octave > 0) {
+            const cv::Mat& previous_last = gaussianLevel(octave - 1, scales_per_octave_ + 1);
+            cv::Mat& next_base = gaussianLevel(octave, 0);
+            downsampleByTwo(viewOf<const float>(previous_last), viewOf<float>(next_base));
+        }
+
+        for (int level = 1; level < scales_per_octave_ + 2; level++) {
+            blur::separableGaussianBlurWithDifference(gaussianLevel(octave, level - 1), gaussianLevel(octave, level),
+                                                      DoG_levels[octave][level - 1], *level_kernels_[level], row_buffer_);
+        }
+    }
+}
+
+cv::Mat& ScaleSpaceBuilder::gaussianLevel(int octave, int level) {
+    if (keep_gaussian_pyramid_) {
+        return gaussian_pyramid_.scaleSpace()[octave][level];
+    }
+    return scratch_headers_[octave][(base_slot_[octave] + level) % 2];
+}
+
+}
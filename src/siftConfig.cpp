@@ -0,0 +1,30 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "siftConfig.hpp"
+
+namespace cfg {
+
+void SiftConfig::validate() const {
+    if (num_octaves < 0 || scales_per_octave <= 0) {
+        throw std::invalid_argument("Number of octaves must not be negative and scales per octave must be positive.");
+    }
+    if (initial_scale <= 0) {
+        throw std::invalid_argument("Initial Scale must be greater than 0.");
+    }
+    if (contrast_threshold <= 0 || edge_threshold <= 0 || offset_limit <= 0) {
+        throw std::invalid_argument("Thresholds must be positive.");
+    }
+    if (num_angle_bins <= 0 || num_radius_bins <= 0) {
+        throw std::invalid_argument("Histogram bin counts must be positive.");
+    }
+}
+
+int SiftConfig::numOctavesFor(cv::Size image_size) const {
+    if (num_octaves > 0) return num_octaves;
+    return std::max(1, static_cast<int>(std::log2(std::min(image_size.width, image_size.height))) - 3);
+}
+
+}
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "scaleSpace.hpp"
+#include "scaleSpaceBuilder.hpp"
+#include "refine.hpp"
+#include "streamingDetector.hpp"
+
+namespace kp {
+
+namespace {
+
+constexpr int kGaussianSlots = 2;
+constexpr int kDoGSlots = 3;
+
+}
+
+StreamingDetector::StreamingDetector(cv::Size frame_size, int numOctaves, int scalesPerOctave, float initial_scale,
+                                     float contrast_threshold, bool refine_keypoints)
+    : frame_size_(frame_size), num_octaves_(numOctaves), scales_per_octave_(scalesPerOctave),
+      contrast_threshold_(contrast_threshold), refine_keypoints_(refine_keypoints) {
+
+    if (numOctaves <= 0 || scalesPerOctave <= 0) {
+        throw std::invalid_argument("Number of octaves and scales per octave must be positive.");
+    }
+    if (initial_scale <= 0) {
+        throw std::invalid_argument("Initial Scale must be greater than 0.");
+    }
+
+    buffers_.allocate(frame_size, 1, kGaussianSlots + kDoGSlots, CV_32F);
+
+    headers_.resize(numOctaves);
+    base_slot_.resize(numOctaves);
+    cv::Size size = frame_size;
+    for (int octave = 0; octave < numOctaves; octave++) {
+        if (octave > 0) {
+            size = cv::Size(cvRound(size.width * 0.5), cvRound(size.height * 0.5));
+            if (size.width <= 0 || size.height <= 0) {
+                throw std::invalid_argument("Too many octaves for the frame size.");
+            }
+        }
+        for (int slot = 0; slot < kGaussianSlots + kDoGSlots; slot++) {
+            ss::LevelView<float> buffer = buffers_.view(0, slot);
+            headers_[octave][slot] = cv::Mat(size, CV_32F, buffer.data, buffer.stride * sizeof(float));
+        }
+        // The next base must not overwrite the last level it is downsampled from
+        int previous_last_slot = octave == 0 ? 1 : (base_slot_[octave - 1] + scalesPerOctave + 1) % kGaussianSlots;
+        base_slot_[octave] = 1 - previous_last_slot;
+    }
+
+    int max_radius = 0;
+    level_kernels_.assign(scalesPerOctave + 2, nullptr);
+    for (int level = 1; level < scalesPerOctave + 2; level++) {
+        float delta_sigma = ss::computeDeltaSigma(ss::computeSigmaForLevel(initial_scale, level - 1, scalesPerOctave),
+                                                  ss::computeSigmaForLevel(initial_scale, level, scalesPerOctave));
+        level_kernels_[level] = &blur::getCachedKernel(delta_sigma);
+        max_radius = std::max(max_radius, level_kernels_[level]->radius);
+    }
+    row_buffer_.resize(frame_size.width + 2 * max_radius);
+
+    refine_window_.assign(numOctaves, ss::Octave(scalesPerOctave + 1));
+}
+
+void StreamingDetector::detect(const cv::Mat& frame, std::vector<KeyPoint>& keypoints) {
+    if (frame.empty() || frame.type() != CV_32F || frame.size() != frame_size_) {
+        throw std::invalid_argument("Frame must be CV_32F and match the detector frame size.");
+    }
+
+    cv::Mat& base = gaussianLevel(0, 0);
+    for (int row = 0; row < base.rows; row++) {
+        std::memcpy(base.ptr<float>(row), frame.ptr<float>(row), base.cols * sizeof(float));
+    }
+
+    for (int octave = 0; octave < num_octaves_; octave++) {
+        if (octave > 0) {
+            ss::downsampleByTwo(ss::viewOf<const float>(gaussianLevel(octave - 1, scales_per_octave_ + 1)),
+                                ss::viewOf<float>(gaussianLevel(octave, 0)));
+        }
+
+        for (int level = 1; level < scales_per_octave_ + 2; level++) {
+            blur::separableGaussianBlurWithDifference(gaussianLevel(octave, level - 1), gaussianLevel(octave, level),
+                                                      DoGLevel(octave, level - 1), *level_kernels_[level], row_buffer_);
+            // DoG level - 1 just landed, so level - 2 has both neighbours
+            if (level >= 3) {
+                scanLevel(octave, level - 2, keypoints);
+            }
+        }
+    }
+}
+
+void StreamingDetector::scanLevel(int octave, int level, std::vector<KeyPoint>& keypoints) {
+    if (!refine_keypoints_) {
+        detectLevelExtrema<float>(ss::viewOf<const float>(DoGLevel(octave, level - 1)), ss::viewOf<const float>(DoGLevel(octave, level)),
+                                  ss::viewOf<const float>(DoGLevel(octave, level + 1)), octave, level, contrast_threshold_, 1.0f,
+                                  keypoints);
+        return;
+    }
+
+    level_keypoints_.clear();
+    detectLevelExtrema<float>(ss::viewOf<const float>(DoGLevel(octave, level - 1)), ss::viewOf<const float>(DoGLevel(octave, level)),
+                              ss::viewOf<const float>(DoGLevel(octave, level + 1)), octave, level, contrast_threshold_, 1.0f,
+                              level_keypoints_);
+
+    // Refinement reads at most one level either side of the keypoint's own
+    ss::Octave& window = refine_window_[octave];
+    std::fill(window.begin(), window.end(), cv::Mat());
+    for (int neighbour = level - 1; neighbour <= level + 1; neighbour++) {
+        window[neighbour] = DoGLevel(octave, neighbour);
+    }
+
+    for (KeyPoint& keypoint : level_keypoints_) {
+        refine::refineKeypoints(refine_window_, keypoint);
+        if (keypoint.x != -1e6 && keypoint.y != -1e6) {
+            keypoints.push_back(keypoint);
+        }
+    }
+}
+
+cv::Mat& StreamingDetector::gaussianLevel(int octave, int level) {
+    return headers_[octave][(base_slot_[octave] + level) % kGaussianSlots];
+}
+
+cv::Mat& StreamingDetector::DoGLevel(int octave, int level) {
+    return headers_[octave][kGaussianSlots + level % kDoGSlots];
+}
+
+}
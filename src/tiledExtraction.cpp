@@ -0,0 +1,194 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "blur.hpp"
+#include "scaleSpace.hpp"
+#include "pyramid.hpp"
+#include "scaleSpaceBuilder.hpp"
+#include "keypointDetection.hpp"
+#include "refine.hpp"
+#include "tiledExtraction.hpp"
+
+namespace tile {
+
+namespace {
+
+size_t alignedRowBytes(int cols) {
+    return (cols * sizeof(float) + ss::Pyramid::kAlignment - 1) / ss::Pyramid::kAlignment * ss::Pyramid::kAlignment;
+}
+
+void validateTilingOptions(const TilingOptions& options) {
+    if (options.num_octaves <= 0 || options.scales_per_octave <= 0) {
+        throw std::invalid_argument("Number of octaves and scales per octave must be positive.");
+    }
+    if (options.initial_scale <= 0) {
+        throw std::invalid_argument("Initial Scale must be greater than 0.");
+    }
+    if (options.max_parallel_tiles < 0) {
+        throw std::invalid_argument("Number of parallel tiles cannot be negative.");
+    }
+}
+
+// Largest core edge (a multiple of 2^numOctaves) whose padded tile fits the per-tile budget.
+int chooseCoreSize(cv::Size image_size, const TilingOptions& options, int halo, size_t tile_budget) {
+    const int step = 1 << options.num_octaves;
+    const int max_core = (std::max(image_size.width, image_size.height) + step - 1) / step * step;
+
+    auto fits = [&](int core) {
+        return estimateTileBytes(cv::Size(core + 2 * halo, core + 2 * halo), options.num_octaves, options.scales_per_octave) <= tile_budget;
+    };
+
+    if (!fits(step)) {
+        throw std::invalid_argument("Memory budget is too small for a single tile and its halo.");
+    }
+
+    int core = step;
+    while (core < max_core && fits(core + step)) {
+        core += step;
+    }
+    return core;
+}
+
+void extractTile(const Tile& tile, const TileReader& reader, const TilingOptions& options, std::vector<kp::KeyPoint>& keypoints) {
+    cv::Mat raw;
+    reader(tile.padded, raw);
+    if (raw.empty() || raw.channels() != 1 || raw.size() != tile.padded.size()) {
+        throw std::logic_error("Tile reader returned an image that does not match the requested region.");
+    }
+
+    cv::Mat input;
+    raw.convertTo(input, CV_32F);
+    raw.release();
+
+    ss::ScaleSpaceBuilder builder(input.size(), options.num_octaves, options.scales_per_octave, options.initial_scale, false);
+    builder.build(input);
+    input.release();
+
+    std::vector<kp::KeyPoint> candidates;
+    kp::coarseKeypointDetection(builder.DoGPyramid(), candidates, options.contrast_threshold);
+
+    for (kp::KeyPoint& keypoint : candidates) {
+        // Coarse positions are exact multiples of 2^octave, so ownership is decided before refinement moves them
+        cv::Point detection(tile.padded.x + static_cast<int>(keypoint.x), tile.padded.y + static_cast<int>(keypoint.y));
+        if (!tile.core.contains(detection)) {
+            continue;
+        }
+
+        refine::refineKeypoints(builder.DoGPyramid(), keypoint);
+        if (keypoint.x == -1e6 || keypoint.y == -1e6) {
+            continue;
+        }
+
+        keypoint.x += tile.padded.x;
+        keypoint.y += tile.padded.y;
+        keypoints.push_back(keypoint);
+    }
+}
+
+}
+
+int computeHalo(int numOctaves, int scalesPerOctave, float initial_scale) {
+    if (numOctaves <= 0 || scalesPerOctave <= 0) {
+        throw std::invalid_argument("Number of octaves and scales per octave must be positive.");
+    }
+    if (initial_scale <= 0) {
+        throw std::invalid_argument("Initial Scale must be greater than 0.");
+    }
+
+    // Every octave runs the same incremental blur chain, so its support is the same in octave pixels
+    int chain_radius = 0;
+    for (int level = 1; level < scalesPerOctave + 2; level++) {
+        float delta_sigma = ss::computeDeltaSigma(ss::computeSigmaForLevel(initial_scale, level - 1, scalesPerOctave),
+                                                  ss::computeSigmaForLevel(initial_scale, level, scalesPerOctave));
+        chain_radius += blur::getCachedKernel(delta_sigma).radius;
+    }
+
+    // Margin (in octave pixels) the base of each octave needs: the blur chain plus one pixel for the
+    // extremum neighbourhood and one for the refinement derivatives, or whatever the next octave needs
+    // from the last level it is downsampled from, whichever is larger.
+    const int own_margin = chain_radius + 2;
+    int margin = own_margin;
+    for (int octave = numOctaves - 2; octave >= 0; octave--) {
+        margin = std::max(own_margin, 2 * margin + 1 + chain_radius);
+    }
+
+    const int step = 1 << numOctaves;
+    return (margin + step - 1) / step * step;
+}
+
+size_t estimateTileBytes(cv::Size padded_size, int numOctaves, int scalesPerOctave) {
+    size_t bytes = 2 * static_cast<size_t>(padded_size.area()) * sizeof(float);  // source tile and its CV_32F copy
+    bytes += 2 * alignedRowBytes(padded_size.width) * padded_size.height;           // Gaussian ping-pong buffers
+
+    cv::Size size = padded_size;
+    for (int octave = 0; octave < numOctaves; octave++) {
+        if (octave > 0) {
+            size = cv::Size(cvRound(size.width * 0.5), cvRound(size.height * 0.5));
+        }
+        bytes += static_cast<size_t>(scalesPerOctave + 1) * alignedRowBytes(size.width) * size.height;
+    }
+    return bytes;
+}
+
+std::vector<Tile> planTiles(cv::Size image_size, int core_size, int halo) {
+    if (image_size.width <= 0 || image_size.height <= 0) {
+        throw std::invalid_argument("Image size must be positive.");
+    }
+    if (core_size <= 0 || halo < 0) {
+        throw std::invalid_argument("Tile core size must be positive and the halo non-negative.");
+    }
+
+    const cv::Rect bounds(cv::Point(0, 0), image_size);
+    std::vector<Tile> tiles;
+    for (int y = 0; y < image_size.height; y += core_size) {
+        for (int x = 0; x < image_size.width; x += core_size) {
+            cv::Rect core = cv::Rect(x, y, core_size, core_size) & bounds;
+            cv::Rect padded = cv::Rect(x - halo, y - halo, core_size + 2 * halo, core_size + 2 * halo) & bounds;
+            tiles.push_back({core, padded});
+        }
+    }
+    return tiles;
+}
+
+void extractKeypointsTiled(cv::Size image_size, const TileReader& reader, const TilingOptions& options,
+                           std::vector<kp::KeyPoint>& keypoints) {
+    validateTilingOptions(options);
+    if (!reader) {
+        throw std::invalid_argument("Tile reader must be callable.");
+    }
+
+    const int parallel_tiles = std::max(1, options.max_parallel_tiles > 0 ? options.max_parallel_tiles : cv::getNumThreads());
+    const int halo = computeHalo(options.num_octaves, options.scales_per_octave, options.initial_scale);
+    const int core_size = chooseCoreSize(image_size, options, halo, options.memory_budget_bytes / parallel_tiles);
+    const std::vector<Tile> tiles = planTiles(image_size, core_size, halo);
+
+    // At most parallel_tiles tiles are resident at once; results are merged in tile order so the output
+    // does not depend on scheduling.
+    for (size_t first = 0; first < tiles.size(); first += parallel_tiles) {
+        const int batch = static_cast<int>(std::min<size_t>(parallel_tiles, tiles.size() - first));
+        std::vector<std::vector<kp::KeyPoint>> batch_keypoints(batch);
+
+        cv::parallel_for_(cv::Range(0, batch), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; i++) {
+                extractTile(tiles[first + i], reader, options, batch_keypoints[i]);
+            }
+        });
+
+        for (const auto& tile_keypoints : batch_keypoints) {
+            keypoints.insert(keypoints.end(), tile_keypoints.begin(), tile_keypoints.end());
+        }
+    }
+}
+
+void extractKeypointsTiled(const cv::Mat& image, const TilingOptions& options, std::vector<kp::KeyPoint>& keypoints) {
+    if (image.empty() || image.channels() != 1) {
+        throw std::invalid_argument("Image must be non-empty and single-channel.");
+    }
+
+    extractKeypointsTiled(image.size(), [&image](const cv::Rect& region, cv::Mat& tile) { tile = image(region); },
+                          options, keypoints);
+}
+
+}
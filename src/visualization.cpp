@@ -38,4 +38,32 @@ void drawKeypointsLines(const cv::Mat& image1, const std::vector<kp::KeyPoint>&
     }
 }
 
+void drawKeypoints(const cv::Mat& image, const kp::KeyPointSet& keypoints,
+    cv::Mat& output, const cv::Scalar& color, int line_thickness) {
+    if(image.empty()){
+      throw std::invalid_argument("Image should not be empty.");
+    }
+
+    if (image.channels() == 1)
+        cv::cvtColor(image, output, cv::COLOR_GRAY2BGR);
+    else
+        output = image.clone();
+
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+      if (!keypoints.isKept(i)) continue;
+      cv::circle(output, {static_cast<int>(keypoints.x()[i]), static_cast<int>(keypoints.y()[i])}, 2, color, line_thickness);
+    }
+}
+
+
+void drawKeypointsLines(const cv::Mat& image1, const kp::KeyPointSet& keypoints1, const cv::Mat&, const kp::KeyPointSet& keypoints2, cv::Mat& output, const cv::Scalar& color, int line_thickness) {
+
+    output = image1.clone();
+    for (size_t i = 0; i < std::min(keypoints1.size(), keypoints2.size()); ++i) {
+        if (keypoints1.isKept(i) && keypoints2.isKept(i)) {
+            cv::line(output, {static_cast<int>(keypoints1.x()[i]), static_cast<int>(keypoints1.y()[i])}, {static_cast<int>(keypoints2.x()[i]), static_cast<int>(keypoints2.y()[i])}, color, line_thickness);
+        }
+    }
+}
+
 }
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include "blur.hpp"
+#include "scaleSpace.hpp"
+
+cv::Mat createBlurTestImage(int rows, int cols) {
+    cv::Mat image(rows, cols, CV_32F);
+    cv::randu(image, 0.0, 255.0);
+    return image;
+}
+
+TEST(GaussianKernelTest, MatchesOpenCVKernel) {
+    blur::GaussianKernel kernel = blur::createGaussianKernel(1.6f);
+    cv::Mat expected = cv::getGaussianKernel(2 * kernel.radius + 1, 1.6, CV_64F);
+
+    ASSERT_EQ(kernel.weights.size(), expected.rows);
+    for (int i = 0; i < expected.rows; ++i) {
+        EXPECT_NEAR(kernel.weights[i], expected.at<double>(i, 0), 1e-6);
+    }
+}
+
+TEST(GaussianKernelTest, InvalidSigmaThrows) {
+    EXPECT_THROW(blur::createGaussianKernel(0.0f), std::invalid_argument);
+}
+
+TEST(GaussianKernelTest, CacheReturnsSameKernel) {
+    const blur::GaussianKernel& first = blur::getCachedKernel(1.2f);
+    const blur::GaussianKernel& second = blur::getCachedKernel(1.2f);
+    EXPECT_EQ(&first, &second);
+    EXPECT_NE(&first, &blur::getCachedKernel(1.3f));
+}
+
+TEST(GaussianKernelTest, CacheKeyIsQuantized) {
+    const blur::GaussianKernel& kernel = blur::getCachedKernel(1.2f);
+    EXPECT_EQ(&kernel, &blur::getCachedKernel(1.2f + 0.25f * blur::kKernelSigmaStep));
+    EXPECT_NEAR(kernel.sigma, 1.2f, blur::kKernelSigmaStep);
+}
+
+TEST(SeparableBlurTest, MatchesOpenCVBlur) {
+    cv::Mat image = createBlurTestImage(37, 53);
+
+    for (float sigma : {0.8f, 1.6f, 3.1f}) {
+        cv::Mat expected, result;
+        cv::GaussianBlur(image, expected, cv::Size(0, 0), sigma, sigma, cv::BORDER_REFLECT101);
+        blur::separableGaussianBlur(image, result, blur::getCachedKernel(sigma));
+
+        EXPECT_LT(cv::norm(expected, result, cv::NORM_INF), 1e-3) << "sigma " << sigma;
+    }
+}
+
+TEST(SeparableBlurTest, HandlesKernelWiderThanImage) {
+    cv::Mat image = createBlurTestImage(4, 6);
+    cv::Mat expected, result;
+    cv::GaussianBlur(image, expected, cv::Size(0, 0), 2.5, 2.5, cv::BORDER_REFLECT101);
+    blur::separableGaussianBlur(image, result, blur::getCachedKernel(2.5f));
+
+    EXPECT_LT(cv::norm(expected, result, cv::NORM_INF), 1e-3);
+}
+
+TEST(SeparableBlurTest, RejectsInvalidInput) {
+    cv::Mat image = cv::Mat::ones(8, 8, CV_8U);
+    cv::Mat result;
+    EXPECT_THROW(blur::separableGaussianBlur(image, result, blur::getCachedKernel(1.0f)), std::invalid_argument);
+
+    cv::Mat float_image = createBlurTestImage(8, 8);
+    EXPECT_THROW(blur::separableGaussianBlur(float_image, float_image, blur::getCachedKernel(1.0f)), std::invalid_argument);
+}
+
+TEST(SeparableBlurTest, ScaleSpaceBackendsAgree) {
+    cv::Mat image = createBlurTestImage(64, 48);
+    ss::ScaleSpace opencv_space, separable_space;
+    ss::ScaleSpaceOptions options;
+
+    ss::prepareScaleSpace(opencv_space, image, 3, 3, 1.6f, options);
+    options.blur_backend = blur::Backend::Separable;
+    ss::prepareScaleSpace(separable_space, image, 3, 3, 1.6f, options);
+
+    ASSERT_EQ(opencv_space.size(), separable_space.size());
+    for (size_t octave = 0; octave < opencv_space.size(); ++octave) {
+        ASSERT_EQ(opencv_space[octave].size(), separable_space[octave].size());
+        for (size_t level = 0; level < opencv_space[octave].size(); ++level) {
+            EXPECT_LT(cv::norm(opencv_space[octave][level], separable_space[octave][level], cv::NORM_INF), 1e-2);
+        }
+    }
+}
+
+TEST(RecursiveBlurTest, ApproximatesGaussianForLargeSigma) {
+    cv::Mat image = createBlurTestImage(80, 96);
+
+    for (float sigma : {4.0f, 6.5f, 10.0f}) {
+        cv::Mat expected, result;
+        cv::GaussianBlur(image, expected, cv::Size(0, 0), sigma, sigma, cv::BORDER_REFLECT101);
+        blur::recursiveGaussianBlur(image, result, sigma);
+
+        // Young-van Vliet is an approximation; about 1% of the range on white noise at sigma 4
+        EXPECT_LT(cv::norm(expected, result, cv::NORM_INF), 0.01 * 255.0) << "sigma " << sigma;
+    }
+}
+
+TEST(RecursiveBlurTest, PreservesConstantImageAndRunsInPlace) {
+    cv::Mat image(40, 30, CV_32F, cv::Scalar(7.0));
+    cv::Mat result;
+    blur::recursiveGaussianBlur(image, result, 5.0f);
+    EXPECT_LT(cv::norm(result, image, cv::NORM_INF), 1e-4);
+
+    cv::Mat noisy = createBlurTestImage(40, 30);
+    cv::Mat copy = noisy.clone();
+    cv::Mat expected;
+    blur::recursiveGaussianBlur(noisy, expected, 3.0f);
+    blur::recursiveGaussianBlur(copy, copy, 3.0f);
+    EXPECT_EQ(cv::norm(expected, copy, cv::NORM_INF), 0.0);
+}
+
+TEST(RecursiveBlurTest, CallerScratchMatchesAllocatingForm) {
+    std::vector<float> scratch;
+    for (cv::Size size : {cv::Size(64, 48), cv::Size(20, 33)}) {
+        cv::Mat image = createBlurTestImage(size.height, size.width);
+        cv::Mat expected, result;
+        blur::recursiveGaussianBlur(image, expected, 4.0f);
+        blur::recursiveGaussianBlur(image, result, 4.0f, scratch);
+        EXPECT_EQ(cv::norm(expected, result, cv::NORM_INF), 0.0);
+    }
+}
+
+TEST(RecursiveBlurTest, RejectsInvalidInput) {
+    cv::Mat result;
+    EXPECT_THROW(blur::recursiveGaussianBlur(createBlurTestImage(8, 8), result, 0.3f), std::invalid_argument);
+    EXPECT_THROW(blur::recursiveGaussianBlur(cv::Mat::ones(8, 8, CV_8U), result, 2.0f), std::invalid_argument);
+}
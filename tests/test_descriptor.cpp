@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include <complex>
+#include <cmath>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
+#include <random>
 #include "descriptor.hpp"
 
 using namespace desc;
@@ -70,3 +75,323 @@ TEST(MatchingTest, MatchesDescriptorSetsCorrectly) {
     EXPECT_EQ(matches[0].idx2, 0);
 }
 
+
+TEST(DescribeKeypointsTest, MatchesHistogramThenDescriptor) {
+    cv::Mat image(40, 48, CV_32F);
+    for (int row = 0; row < image.rows; ++row)
+        for (int col = 0; col < image.cols; ++col)
+            image.at<float>(row, col) = static_cast<float>((row * 5 + col * 11) % 23);
+
+    std::vector<std::vector<float>> image_vec(image.rows, std::vector<float>(image.cols));
+    for (int row = 0; row < image.rows; ++row)
+        for (int col = 0; col < image.cols; ++col)
+            image_vec[row][col] = image.at<float>(row, col);
+
+    kp::KeyPointSet keypoints({{10.0f, 12.0f, 1.5f, 0}, {30.0f, 20.0f, 2.0f, 0}, {44.0f, 36.0f, 2.5f, 0}});
+    keypoints.reject(1);
+
+    std::vector<Desc> descriptors = describeKeypoints(ss::viewOf<const float>(image), keypoints);
+    ASSERT_EQ(descriptors.size(), 2u);
+    for (size_t i : {0u, 2u}) {
+        std::vector<std::vector<float>> hist;
+        hist::generateLogPolarHistogram(image_vec, keypoints[i], 8, 4, hist);
+        Desc expected = createDescStruct(hist);
+        const Desc& actual = descriptors[i == 0 ? 0 : 1];
+        EXPECT_EQ(actual.descriptor, expected.descriptor);
+        EXPECT_EQ(actual.dominant_orientation, expected.dominant_orientation);
+    }
+}
+
+TEST(DescriptorEngineTest, MortonKeyInterleavesCoordinates) {
+    EXPECT_EQ(mortonKey(0, 0, 1), 1u);
+    EXPECT_EQ(mortonKey(0, 1, 0), 2u);
+    EXPECT_EQ(mortonKey(0, 3, 3), 15u);
+    EXPECT_LT(mortonKey(0, 1, 1), mortonKey(0, 0, 2));
+    EXPECT_LT(mortonKey(0, 0xFFFF, 0xFFFF), mortonKey(1, 0, 0));
+}
+
+// Two octaves of four uniform-noise levels, each octave half the size of the previous one
+ss::ScaleSpace createNoiseScaleSpace(const cv::Size& size) {
+    ss::ScaleSpace gaussian(2);
+    for (int octave = 0; octave < 2; ++octave) {
+        for (int level = 0; level < 4; ++level) {
+            cv::Mat noise(size.height >> octave, size.width >> octave, CV_32F);
+            cv::randu(noise, 0.0, 255.0);
+            gaussian[octave].push_back(noise);
+        }
+    }
+    return gaussian;
+}
+
+// Keypoints spread over the whole image (including its borders), alternating octaves and cycling scales
+std::vector<kp::KeyPoint> createScatteredKeypoints(int count, const cv::Size& size) {
+    std::vector<kp::KeyPoint> points;
+    for (int i = 0; i < count; ++i) {
+        points.push_back({static_cast<float>((i * 37) % size.width), static_cast<float>((i * 23) % size.height), 0.6f + (i % 4) * 0.8f, i % 2});
+    }
+    return points;
+}
+
+TEST(DescriptorEngineTest, MatchesPerKeypointDescriptorsInInputOrder) {
+    ss::ScaleSpace gaussian = createNoiseScaleSpace(cv::Size(72, 64));
+    kp::KeyPointSet keypoints(createScatteredKeypoints(100, cv::Size(72, 64)));
+    keypoints.reject(7);
+    keypoints.reject(50);
+
+    cfg::SiftConfig config;
+    std::vector<Desc> expected = describeKeypoints(gaussian, keypoints, config);
+
+    exec::Executor reversed = [](int num_tasks, const std::function<void(int)>& task) {
+        for (int i = num_tasks - 1; i >= 0; --i) task(i);
+    };
+    for (const exec::Executor& executor : {exec::Executor(), exec::serialExecutor(), reversed}) {
+        DescriptorMatrix matrix = extractDescriptors(gaussian, keypoints, config, executor);
+        ASSERT_EQ(matrix.rows(), 98);
+        ASSERT_EQ(matrix.cols(), 32);
+        for (int row = 0; row < matrix.rows(); ++row) {
+            Desc desc = matrix.toDesc(row);
+            EXPECT_EQ(desc.descriptor, expected[row].descriptor);
+            EXPECT_EQ(desc.dominant_orientation, expected[row].dominant_orientation);
+        }
+    }
+}
+
+TEST(DescriptorEngineTest, GradientHistogramsAgreeAcrossMapModes) {
+    ss::ScaleSpace gaussian = createNoiseScaleSpace(cv::Size(56, 48));
+    kp::KeyPointSet keypoints(createScatteredKeypoints(80, cv::Size(56, 48)));
+
+    cfg::SiftConfig config;
+    config.histogram_source = cfg::HistogramSource::GradientMagnitude;
+    config.map_mode = cfg::MapMode::OnDemand;
+    std::vector<Desc> expected = describeKeypoints(gaussian, keypoints, config);
+    DescriptorMatrix intensity = extractDescriptors(gaussian, keypoints);
+
+    for (cfg::MapMode mode : {cfg::MapMode::OnDemand, cfg::MapMode::Precomputed, cfg::MapMode::Automatic}) {
+        config.map_mode = mode;
+        DescriptorMatrix matrix = extractDescriptors(gaussian, keypoints, config);
+        ASSERT_EQ(matrix.rows(), 80);
+        for (int row = 0; row < matrix.rows(); ++row) {
+            Desc desc = matrix.toDesc(row);
+            EXPECT_EQ(desc.descriptor, expected[row].descriptor);
+            EXPECT_EQ(desc.dominant_orientation, expected[row].dominant_orientation);
+        }
+    }
+    EXPECT_NE(intensity.toDesc(0).descriptor, expected[0].descriptor);
+}
+
+TEST(RealFFTTest, MatchesDirectDFT) {
+    for (int n : {1, 2, 4, 8, 12, 30, 32, 64, 128, 256}) {
+        std::vector<float> input(n);
+        for (int i = 0; i < n; ++i) input[i] = std::sin(0.7f * i) + 0.25f * (i % 3);
+
+        std::vector<std::complex<float>> expected = calculateDFT(input);
+        std::vector<std::complex<float>> full = calculateRealFFT(input);
+        std::vector<std::complex<float>> half = calculateRealFFT(input, true);
+        ASSERT_EQ(full.size(), static_cast<size_t>(n));
+        ASSERT_EQ(half.size(), static_cast<size_t>(n / 2 + 1));
+
+        // calculateDFT rounds its angles in float, so allow for its error growing with n
+        const float tolerance = 1e-5f * n * n;
+        for (int k = 0; k < n; ++k) {
+            EXPECT_NEAR(full[k].real(), expected[k].real(), tolerance) << "n = " << n << ", k = " << k;
+            EXPECT_NEAR(full[k].imag(), expected[k].imag(), tolerance) << "n = " << n << ", k = " << k;
+        }
+        for (int k = 0; k <= n / 2; ++k) {
+            EXPECT_EQ(half[k], full[k]);
+        }
+    }
+    EXPECT_THROW(calculateRealFFT(nullptr, 0, nullptr), std::invalid_argument);
+}
+
+TEST(RealFFTTest, HalfSpectrumDescriptors) {
+    std::vector<std::vector<float>> hist(8, std::vector<float>(4));
+    for (int a = 0; a < 8; ++a)
+        for (int r = 0; r < 4; ++r)
+            hist[a][r] = static_cast<float>((a * 5 + r * 3) % 7);
+
+    Desc full = createDescStruct(hist);
+    Desc half = createDescStruct(hist, true);
+    ASSERT_EQ(full.descriptor.size(), 32u);
+    ASSERT_EQ(half.descriptor.size(), 17u);
+    EXPECT_EQ(half.dominant_orientation, full.dominant_orientation);
+
+    // Both are unit length: the half spectrum is the leading part of the full one, with the coefficients
+    // that stand for a conjugate pair weighted by sqrt(2)
+    for (int k = 0; k < 17; ++k) {
+        const float weight = (k == 0 || k == 16) ? 1.0f : std::sqrt(2.0f);
+        EXPECT_NEAR(std::abs(half.descriptor[k]), weight * std::abs(full.descriptor[k]), 1e-5f);
+    }
+}
+
+TEST(RealFFTTest, HalfSpectrumKeepsMatches) {
+    std::vector<Desc> full1, full2, half1, half2;
+    for (int i = 0; i < 30; ++i) {
+        std::vector<std::vector<float>> hist1(8, std::vector<float>(4)), hist2(8, std::vector<float>(4));
+        for (int a = 0; a < 8; ++a) {
+            for (int r = 0; r < 4; ++r) {
+                hist1[a][r] = std::abs(std::sin(0.37f * i * (a + 1) + 1.3f * r));
+                hist2[a][r] = hist1[a][r] + 0.05f * std::cos(2.1f * i + a - r);
+            }
+        }
+        full1.push_back(createDescStruct(hist1));
+        full2.push_back(createDescStruct(hist2));
+        half1.push_back(createDescStruct(hist1, true));
+        half2.push_back(createDescStruct(hist2, true));
+    }
+    EXPECT_NEAR(euclideanDistance(half1[3].descriptor, half2[5].descriptor), euclideanDistance(full1[3].descriptor, full2[5].descriptor), 1e-5f);
+
+    for (float ratio : {0.6f, 0.8f, 0.95f}) {
+        std::vector<Match> full = matchDescriptorSets(full1, full2, ratio);
+        std::vector<Match> half = matchDescriptorSets(half1, half2, ratio);
+        ASSERT_FALSE(full.empty());
+        ASSERT_EQ(half.size(), full.size()) << "ratio " << ratio;
+        for (size_t i = 0; i < full.size(); ++i) {
+            EXPECT_EQ(half[i].idx1, full[i].idx1);
+            EXPECT_EQ(half[i].idx2, full[i].idx2);
+            EXPECT_NEAR(half[i].distance, full[i].distance, 1e-5f);
+        }
+    }
+}
+
+TEST(DescriptorMatrixTest, LayoutsAreAlignedAndRoundTrip) {
+    std::vector<Desc> descs;
+    for (int i = 0; i < 5; ++i) {
+        std::vector<std::complex<float>> values(17);
+        for (int k = 0; k < 17; ++k) values[k] = {0.1f * i + k, -0.5f * k};
+        descs.push_back({values, 10.0f * i});
+    }
+
+    for (DescriptorLayout layout : {DescriptorLayout::Interleaved, DescriptorLayout::Split}) {
+        DescriptorMatrix matrix = DescriptorMatrix::fromDescs(descs, layout);
+        ASSERT_EQ(matrix.rows(), 5);
+        ASSERT_EQ(matrix.cols(), 17);
+        EXPECT_EQ(matrix.rowStride() % DescriptorMatrix::kAlignmentFloats, 0);
+        for (int i = 0; i < matrix.rows(); ++i) {
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(matrix.row(i)) % 64, 0u);
+            EXPECT_EQ(matrix.toDesc(i).descriptor, descs[i].descriptor);
+            EXPECT_EQ(matrix.orientations()[i], descs[i].dominant_orientation);
+        }
+        if (layout == DescriptorLayout::Split) {
+            EXPECT_EQ(matrix.row(2)[matrix.splitOffset() + 3], descs[2].descriptor[3].imag());
+        } else {
+            EXPECT_EQ(matrix.row(2)[7], descs[2].descriptor[3].imag());
+        }
+    }
+
+    std::vector<Desc> ragged = descs;
+    ragged[1].descriptor.pop_back();
+    EXPECT_THROW(DescriptorMatrix::fromDescs(ragged), std::invalid_argument);
+}
+
+TEST(DescriptorMatrixTest, MatchingAgreesWithDescVectors) {
+    std::vector<Desc> set1, set2;
+    for (int i = 0; i < 12; ++i) {
+        std::vector<std::complex<float>> a(32), b(32);
+        for (int k = 0; k < 32; ++k) {
+            a[k] = {std::sin(0.3f * i * k + 0.1f * k), std::cos(0.7f * i + k)};
+            b[k] = a[k] + std::complex<float>(0.01f * ((i + k) % 3), 0.0f);
+        }
+        set1.push_back({a, 0.0f});
+        set2.push_back({b, 0.0f});
+    }
+    std::vector<Match> expected = matchDescriptorSets(set1, set2);
+    ASSERT_FALSE(expected.empty());
+
+    for (DescriptorLayout layout : {DescriptorLayout::Interleaved, DescriptorLayout::Split}) {
+        DescriptorMatrix m1 = DescriptorMatrix::fromDescs(set1, layout), m2 = DescriptorMatrix::fromDescs(set2, layout);
+        EXPECT_NEAR(euclideanDistance(m1, 3, m2, 5), euclideanDistance(set1[3].descriptor, set2[5].descriptor), 1e-4f);
+
+        std::vector<Match> matches = matchDescriptorSets(m1, m2);
+        ASSERT_EQ(matches.size(), expected.size());
+        for (size_t i = 0; i < matches.size(); ++i) {
+            EXPECT_EQ(matches[i].idx1, expected[i].idx1);
+            EXPECT_EQ(matches[i].idx2, expected[i].idx2);
+            EXPECT_NEAR(matches[i].distance, expected[i].distance, 1e-4f);
+        }
+    }
+
+    DescriptorMatrix split = DescriptorMatrix::fromDescs(set1, DescriptorLayout::Split);
+    EXPECT_THROW(matchDescriptorSets(DescriptorMatrix::fromDescs(set1), split), std::invalid_argument);
+}
+
+TEST(DescriptorMatrixTest, ExtractionLayoutsHoldTheSameDescriptors) {
+    ss::ScaleSpace gaussian(1);
+    for (int level = 0; level < 4; ++level) {
+        cv::Mat noise(40, 40, CV_32F);
+        cv::randu(noise, 0.0, 255.0);
+        gaussian[0].push_back(noise);
+    }
+    kp::KeyPointSet keypoints({{10.0f, 12.0f, 1.0f, 0}, {25.0f, 30.0f, 2.0f, 0}, {33.0f, 5.0f, 1.5f, 0}});
+
+    DescriptorMatrix interleaved = extractDescriptors(gaussian, keypoints);
+    DescriptorMatrix split = extractDescriptors(gaussian, keypoints, {}, {}, DescriptorLayout::Split);
+    ASSERT_EQ(split.rows(), 3);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(split.toDesc(i).descriptor, interleaved.toDesc(i).descriptor);
+    }
+}
+
+TEST(DistanceKernelTest, BackendsMatchScalar) {
+    std::mt19937 rng(25);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    const SquaredDistanceKernel scalar = squaredDistanceKernel(DistanceBackend::Scalar);
+    for (DistanceBackend backend : {DistanceBackend::SSE42, DistanceBackend::AVX2, DistanceBackend::AVX512}) {
+        if (!distanceBackendSupported(backend)) {
+            EXPECT_THROW(squaredDistanceKernel(backend), std::invalid_argument);
+            continue;
+        }
+        const SquaredDistanceKernel kernel = squaredDistanceKernel(backend);
+        for (int n : {0, 1, 3, 7, 8, 15, 16, 17, 31, 32, 33, 64, 100, 256}) {
+            std::vector<float> a(n), b(n);
+            for (int k = 0; k < n; ++k) {
+                a[k] = uniform(rng);
+                b[k] = uniform(rng);
+            }
+            const float expected = scalar(a.data(), b.data(), n);
+            EXPECT_NEAR(kernel(a.data(), b.data(), n), expected, 1e-5f * (1.0f + expected))
+                << distanceBackendName(backend) << " n=" << n;
+        }
+    }
+    EXPECT_TRUE(distanceBackendSupported(activeDistanceBackend()));
+}
+
+TEST(DistanceKernelTest, SquaredRatioTestKeepsScalarMatches) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::vector<Desc> set1, set2;
+    for (int i = 0; i < 40; ++i) {
+        std::vector<std::complex<float>> a(64), b(64);
+        for (int k = 0; k < 64; ++k) {
+            a[k] = {uniform(rng), uniform(rng)};
+            b[k] = a[k] + std::complex<float>(0.3f * uniform(rng), 0.3f * uniform(rng));
+        }
+        set1.push_back({a, 0.0f});
+        set2.push_back({b, 0.0f});
+    }
+
+    // Reference: the sqrt-per-pair ratio test on the scalar kernel
+    const SquaredDistanceKernel scalar = squaredDistanceKernel(DistanceBackend::Scalar);
+    std::vector<Match> expected;
+    for (int i = 0; i < 40; ++i) {
+        float best = std::numeric_limits<float>::max(), second = best;
+        int best_j = -1;
+        for (int j = 0; j < 40; ++j) {
+            const float dist = std::sqrt(scalar(reinterpret_cast<const float*>(set1[i].descriptor.data()),
+                                                reinterpret_cast<const float*>(set2[j].descriptor.data()), 128));
+            if (dist < best) { second = best; best = dist; best_j = j; }
+            else if (dist < second) second = dist;
+        }
+        if (best < 0.8f * second) expected.push_back({i, best_j, best});
+    }
+    ASSERT_FALSE(expected.empty());
+
+    const DescriptorMatrix m1 = DescriptorMatrix::fromDescs(set1), m2 = DescriptorMatrix::fromDescs(set2);
+    for (const std::vector<Match>& matches : {matchDescriptorSets(set1, set2), matchDescriptorSets(m1, m2)}) {
+        ASSERT_EQ(matches.size(), expected.size());
+        for (size_t i = 0; i < matches.size(); ++i) {
+            EXPECT_EQ(matches[i].idx1, expected[i].idx1);
+            EXPECT_EQ(matches[i].idx2, expected[i].idx2);
+            EXPECT_NEAR(matches[i].distance, expected[i].distance, 1e-4f);
+        }
+    }
+}
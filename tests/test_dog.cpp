@@ -106,3 +106,28 @@ TEST(dogCalculationTest, CorrectDifference) {
   cv::Mat expected = (cv::Mat_<float>(2, 2) << 1.0, 1.0, 1.0, 1.0);
   EXPECT_TRUE(cv::countNonZero(DoG_octave[0] != expected) == 0);
 }
+
+// The pyramid DoG unrolls 5 and 7 level octaves; every level count must match plain level subtraction
+TEST(dogCalculationTest, PyramidMatchesLevelSubtraction) {
+  for (int depth : {CV_32F, CV_16S}) {
+    for (int levels : {4, 5, 7}) {
+      ss::Pyramid gaussian(cv::Size(37, 22), 2, levels, depth), DoG;
+      for (int octave = 0; octave < 2; ++octave) {
+        for (int level = 0; level < levels; ++level) {
+          cv::Mat level_mat = gaussian.mat(octave, level);
+          cv::randu(level_mat, -1000, 1000);
+        }
+      }
+
+      dog::calculateDifferenceOfGaussians(gaussian, DoG);
+      ASSERT_EQ(DoG.levelsPerOctave(), levels - 1);
+      for (int octave = 0; octave < 2; ++octave) {
+        for (int level = 0; level + 1 < levels; ++level) {
+          cv::Mat expected;
+          cv::subtract(gaussian.mat(octave, level + 1), gaussian.mat(octave, level), expected);
+          EXPECT_EQ(cv::norm(DoG.mat(octave, level), expected, cv::NORM_INF), 0.0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include "executor.hpp"
+
+TEST(ExecutorTest, RunsEveryTaskOnce) {
+    for (const exec::Executor& executor : {exec::openCVExecutor(), exec::serialExecutor()}) {
+        std::vector<std::atomic<int>> runs(37);
+        executor(37, [&](int i) { runs[i]++; });
+        for (const auto& count : runs) {
+            EXPECT_EQ(count.load(), 1);
+        }
+    }
+}
+
+TEST(ExecutorTest, SerialRunsInOrderAndEmptyFallsBack) {
+    std::vector<int> order;
+    exec::serialExecutor()(4, [&](int i) { order.push_back(i); });
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+
+    std::atomic<int> total{0};
+    exec::orDefault(exec::Executor())(5, [&](int i) { total += i; });
+    EXPECT_EQ(total.load(), 10);
+}
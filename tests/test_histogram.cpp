@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <algorithm>
 #include <numbers>
 #include <vector>
+#include <stdexcept>
 #include "histogram.hpp"
 
 TEST(HistogramUtilsTest, GeneratesCorrectCircularMask) {
@@ -64,3 +66,182 @@ TEST(HistogramUtilsTest, GeneratesReasonableHistogram) {
     EXPECT_EQ(hist.size(), angle_bins);
     EXPECT_EQ(hist[0].size(), radius_bins);
 }
+
+std::vector<std::vector<float>> createHistogramTestImage() {
+    std::vector<std::vector<float>> image(32, std::vector<float>(32));
+    for (int row = 0; row < 32; ++row)
+        for (int col = 0; col < 32; ++col)
+            image[row][col] = static_cast<float>((row * 7 + col * 13) % 17);
+    return image;
+}
+
+// Per-sample evaluation of the window, bins and weights, as the histogram was computed before tables
+std::vector<std::vector<float>> directLogPolarHistogram(const std::vector<std::vector<float>>& image, const kp::KeyPoint& kp,
+                                                        int angle_bins, int radius_bins) {
+    std::vector<std::vector<float>> hist(angle_bins, std::vector<float>(radius_bins, 0.0f));
+    const float sigma = kp.scale_idx;
+    const float max_radius = std::max(4.5f * sigma, 1e-6f);
+    const int x0 = static_cast<int>(std::round(kp.x)), y0 = static_cast<int>(std::round(kp.y));
+    for (const auto& [dx, dy] : hist::generateCircularMask(max_radius)) {
+        const int x = x0 + dx, y = y0 + dy;
+        if (x < 0 || x >= static_cast<int>(image[0].size()) || y < 0 || y >= static_cast<int>(image.size())) continue;
+        auto [angle, log_radius] = (dx == 0 && dy == 0) ? std::make_pair(0.0f, std::log(1e-6f))
+                                                        : hist::calculateAngleAndLogRadius(dx, dy, max_radius);
+        const int angle_bin = static_cast<int>((angle / 360.0f) * angle_bins) % angle_bins;
+        const int radius_bin = std::clamp(static_cast<int>(log_radius / std::log(max_radius) * radius_bins), 0, radius_bins - 1);
+        hist[angle_bin][radius_bin] += hist::calculateGaussianWindowWeight(dx, dy, sigma) * image[y][x];
+    }
+    return hist;
+}
+
+TEST(HistogramUtilsTest, FixedShapeMatchesRuntimeShape) {
+    auto image = createHistogramTestImage();
+    kp::KeyPoint kp = {15.0f, 17.0f, 2.5f, 0};
+    const hist::LogPolarTable table = hist::buildLogPolarTable(2.5f, 8, 4);
+
+    std::vector<std::vector<float>> fixed, runtime, configured;
+    hist::logPolarHistogram<8, 4>(image, kp, table, fixed);
+    hist::logPolarHistogram<0, 0>(image, kp, table, runtime);
+    hist::generateLogPolarHistogram(image, kp, cfg::SiftConfig{}, configured);
+    EXPECT_EQ(fixed, runtime);
+    EXPECT_EQ(configured, runtime);
+
+    const hist::LogPolarTable other_shape = hist::buildLogPolarTable(2.5f, 6, 4);
+    EXPECT_THROW((hist::logPolarHistogram<8, 4>(image, kp, other_shape, fixed)), std::invalid_argument);
+}
+
+TEST(HistogramUtilsTest, TableHistogramMatchesDirectEvaluation) {
+    auto image = createHistogramTestImage();
+    for (int angle_bins : {8, 12}) {
+        for (float sigma : {0.5f, 1.0f, 2.5f, 3.25f}) {
+            kp::KeyPoint kp = {14.0f, 18.0f, sigma, 0};
+            std::vector<std::vector<float>> hist;
+            hist::generateLogPolarHistogram(image, kp, angle_bins, 4, hist);
+            EXPECT_EQ(hist, directLogPolarHistogram(image, kp, angle_bins, 4));
+        }
+    }
+}
+
+TEST(HistogramUtilsTest, TableCacheQuantizesSigma) {
+    hist::LogPolarTableCache cache(0.25f);
+    auto first = cache.get(2.01f, 8, 4);
+    EXPECT_EQ(first->sigma, 2.0f);
+    EXPECT_EQ(cache.get(1.95f, 8, 4), first);
+    EXPECT_NE(cache.get(2.01f, 12, 4), first);
+    EXPECT_NE(cache.get(2.2f, 8, 4), first);
+    EXPECT_EQ(cache.size(), 3u);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_FALSE(first->samples.empty());
+
+    EXPECT_THROW(hist::LogPolarTableCache(0.0f), std::invalid_argument);
+    EXPECT_THROW(hist::buildLogPolarTable(1.0f, 0, 4), std::invalid_argument);
+}
+
+TEST(HistogramUtilsTest, ViewMatchesNestedVector) {
+    auto image = createHistogramTestImage();
+    // Wider parent Mat, so the view has a stride larger than its width
+    cv::Mat parent(32, 40, CV_32F, cv::Scalar(-1.0f));
+    for (int row = 0; row < 32; ++row)
+        for (int col = 0; col < 32; ++col)
+            parent.at<float>(row, col + 4) = image[row][col];
+    cv::Mat roi = parent(cv::Rect(4, 0, 32, 32));
+
+    // Centres inside, near and on the border
+    for (kp::KeyPoint kp : {kp::KeyPoint{15.0f, 17.0f, 2.0f, 0}, kp::KeyPoint{2.0f, 29.0f, 1.5f, 0}, kp::KeyPoint{31.0f, 0.0f, 3.0f, 0}}) {
+        std::vector<std::vector<float>> from_vector, from_view;
+        hist::generateLogPolarHistogram(image, kp, 8, 4, from_vector);
+        hist::generateLogPolarHistogram(ss::viewOf<const float>(roi), kp, 8, 4, from_view);
+        EXPECT_EQ(from_view, from_vector);
+    }
+}
+
+TEST(HistogramUtilsTest, OctaveSamplingReadsKeypointLevel) {
+    // Two octaves of three levels, all zero except one sample of octave 1, level 2
+    ss::ScaleSpace gaussian(2);
+    for (int octave = 0; octave < 2; ++octave) {
+        for (int level = 0; level < 3; ++level) {
+            gaussian[octave].push_back(cv::Mat::zeros(32 >> octave, 40 >> octave, CV_32F));
+        }
+    }
+    gaussian[1][2].at<float>(12, 10) = 3.0f;
+
+    cfg::SiftConfig config;
+    kp::KeyPoint kp = {20.0f, 24.0f, 1.8f, 1};
+    std::vector<std::vector<float>> hist;
+    hist::generateOctaveLogPolarHistogram(gaussian, kp, config, hist);
+
+    // Only the centre sample (weight 1) contributes, to angle bin 0 and the innermost radius bin
+    ASSERT_EQ(hist.size(), 8u);
+    for (int angle_bin = 0; angle_bin < 8; ++angle_bin)
+        for (int radius_bin = 0; radius_bin < 4; ++radius_bin)
+            EXPECT_FLOAT_EQ(hist[angle_bin][radius_bin], angle_bin == 0 && radius_bin == 0 ? 3.0f : 0.0f);
+
+    // The same octave coordinates in octave 0 read a level that is all zero
+    kp::KeyPoint fine = {10.0f, 12.0f, 1.8f, 0};
+    hist::generateOctaveLogPolarHistogram(gaussian, fine, config, hist);
+    for (const auto& row : hist)
+        for (float value : row)
+            EXPECT_EQ(value, 0.0f);
+
+    kp.octave_idx = 2;
+    EXPECT_THROW(hist::generateOctaveLogPolarHistogram(gaussian, kp, config, hist), std::out_of_range);
+}
+
+TEST(HistogramUtilsTest, LevelMapsHoldCentralDifferences) {
+    // Ramp rising 2 per column and 1 per row
+    cv::Mat level(6, 7, CV_32F);
+    for (int row = 0; row < 6; ++row)
+        for (int col = 0; col < 7; ++col)
+            level.at<float>(row, col) = 2.0f * col + row;
+
+    hist::LevelMaps maps;
+    hist::computeLevelMaps(ss::viewOf<const float>(level), maps);
+    EXPECT_FLOAT_EQ(maps.magnitude.at<float>(3, 3), std::sqrt(4.0f * 4.0f + 2.0f * 2.0f));
+    EXPECT_NEAR(maps.orientation.at<float>(3, 3), std::atan2(2.0f, 4.0f) * 180.0f / std::numbers::pi_v<float>, 1e-4f);
+    // Replicated border: one-sided differences on both axes
+    EXPECT_FLOAT_EQ(maps.magnitude.at<float>(0, 0), std::sqrt(2.0f * 2.0f + 1.0f * 1.0f));
+    EXPECT_EQ(maps.intensity.data, level.ptr<float>(0));
+}
+
+TEST(HistogramUtilsTest, GradientHistogramModesAgree) {
+    ss::ScaleSpace gaussian(2);
+    for (int octave = 0; octave < 2; ++octave) {
+        for (int level = 0; level < 4; ++level) {
+            cv::Mat noise(48 >> octave, 56 >> octave, CV_32F);
+            cv::randu(noise, 0.0, 255.0);
+            cv::GaussianBlur(noise, noise, cv::Size(0, 0), 1.5);
+            gaussian[octave].push_back(noise);
+        }
+    }
+
+    std::vector<kp::KeyPoint> points;
+    for (int i = 0; i < 40; ++i) {
+        points.push_back({static_cast<float>((i * 17) % 56), static_cast<float>((i * 29) % 48), 0.5f + (i % 5) * 0.6f, i % 2});
+    }
+    kp::KeyPointSet keypoints(points);
+    keypoints.reject(3);
+
+    cfg::SiftConfig config;
+    std::vector<hist::GradientHistogram> on_demand, precomputed, automatic;
+    hist::generateGradientHistograms(gaussian, keypoints, config, on_demand, hist::MapMode::OnDemand);
+    hist::generateGradientHistograms(gaussian, keypoints, config, precomputed, hist::MapMode::Precomputed);
+    hist::generateGradientHistograms(gaussian, keypoints, config, automatic);
+
+    ASSERT_EQ(on_demand.size(), 39u);
+    ASSERT_EQ(precomputed.size(), on_demand.size());
+    ASSERT_EQ(automatic.size(), on_demand.size());
+    for (size_t i = 0; i < on_demand.size(); ++i) {
+        EXPECT_EQ(precomputed[i].histogram, on_demand[i].histogram);
+        EXPECT_EQ(automatic[i].histogram, on_demand[i].histogram);
+        EXPECT_EQ(precomputed[i].dominant_orientation, on_demand[i].dominant_orientation);
+        EXPECT_EQ(automatic[i].dominant_orientation, on_demand[i].dominant_orientation);
+    }
+}
+
+TEST(HistogramUtilsTest, MapModeFollowsKeypointDensity) {
+    const cv::Size level_size(200, 100);
+    EXPECT_EQ(hist::chooseMapMode({2.0f}, level_size), hist::MapMode::OnDemand);
+    EXPECT_EQ(hist::chooseMapMode(std::vector<float>(100, 2.0f), level_size), hist::MapMode::Precomputed);
+}
@@ -76,3 +76,132 @@ TEST(CoarseKeypointDetectionTest, NoKeypointsWhenBelowThreshold) {
 
     EXPECT_TRUE(keypoints.empty());
 }
+
+// Coarse quantization makes equal neighbours common, which is where strict comparisons are easiest to get wrong.
+ss::Octave createRandomDoGOctave(int rows, int cols, int levels) {
+    ss::Octave octave;
+    for (int i = 0; i < levels; ++i) {
+        cv::Mat level(rows, cols, CV_32F);
+        cv::randu(level, -4.0, 4.0);
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                level.at<float>(row, col) = std::round(level.at<float>(row, col) * 2.0f) / 2.0f;
+            }
+        }
+        octave.push_back(level);
+    }
+    return octave;
+}
+
+TEST(CoarseKeypointDetectionTest, RowScanMatchesPerPixelTest) {
+    for (int cols : {5, 11, 37, 64}) {
+        ss::ScaleSpace scale_space = {createRandomDoGOctave(23, cols, 5), createRandomDoGOctave(12, cols / 2 + 3, 5)};
+        const float threshold = 1.0f;
+
+        std::vector<kp::KeyPoint> expected;
+        for (int octave_idx = 0; octave_idx < 2; ++octave_idx) {
+            const ss::Octave& octave = scale_space[octave_idx];
+            for (int scale_idx = 1; scale_idx < 4; ++scale_idx) {
+                for (int row = 1; row < octave[0].rows - 1; ++row) {
+                    for (int col = 1; col < octave[0].cols - 1; ++col) {
+                        if (kp::isLocalExtremaPerOctave(octave, scale_idx, row, col, threshold)) {
+                            expected.push_back({static_cast<float>(col << octave_idx), static_cast<float>(row << octave_idx),
+                                                static_cast<float>(scale_idx), octave_idx, octave[scale_idx].at<float>(row, col)});
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<kp::KeyPoint> keypoints;
+        kp::coarseKeypointDetection(scale_space, keypoints, threshold);
+
+        ASSERT_FALSE(expected.empty());
+        ASSERT_EQ(keypoints.size(), expected.size()) << "cols " << cols;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(keypoints[i].x, expected[i].x);
+            EXPECT_EQ(keypoints[i].y, expected[i].y);
+            EXPECT_EQ(keypoints[i].scale_idx, expected[i].scale_idx);
+            EXPECT_EQ(keypoints[i].octave_idx, expected[i].octave_idx);
+            EXPECT_EQ(keypoints[i].DoG_value, expected[i].DoG_value);
+        }
+    }
+}
+
+TEST(CoarseKeypointDetectionTest, FixedPointRowScanMatchesFloatTest) {
+    // Integer samples widened to float are exact, so the float scan is the reference for the int16 lanes,
+    // including a fractional threshold and row tails of every length
+    for (int cols : {5, 17, 37, 70}) {
+        ss::Octave values = createRandomDoGOctave(21, cols, 3);
+        ss::Octave fixed(3), widened(3);
+        for (int level = 0; level < 3; ++level) {
+            values[level].convertTo(fixed[level], CV_16S, 100.0);
+            fixed[level].convertTo(widened[level], CV_32F);
+        }
+
+        for (float threshold : {0.0f, 150.5f, 400.0f}) {
+            std::vector<kp::KeyPoint> expected, keypoints;
+            kp::detectLevelExtrema<float>(ss::viewOf<const float>(widened[0]), ss::viewOf<const float>(widened[1]),
+                                          ss::viewOf<const float>(widened[2]), 0, 1, threshold, 100.0f, expected);
+            kp::detectLevelExtrema<short>(ss::viewOf<const short>(fixed[0]), ss::viewOf<const short>(fixed[1]),
+                                          ss::viewOf<const short>(fixed[2]), 0, 1, threshold, 100.0f, keypoints);
+            ASSERT_EQ(keypoints.size(), expected.size()) << "cols " << cols << " threshold " << threshold;
+            for (size_t i = 0; i < expected.size(); ++i) {
+                EXPECT_EQ(keypoints[i].x, expected[i].x);
+                EXPECT_EQ(keypoints[i].y, expected[i].y);
+                EXPECT_EQ(keypoints[i].DoG_value, expected[i].DoG_value);
+            }
+        }
+    }
+}
+
+void expectIdenticalKeypoints(const std::vector<kp::KeyPoint>& actual, const std::vector<kp::KeyPoint>& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(actual[i].x, expected[i].x);
+        EXPECT_EQ(actual[i].y, expected[i].y);
+        EXPECT_EQ(actual[i].scale_idx, expected[i].scale_idx);
+        EXPECT_EQ(actual[i].octave_idx, expected[i].octave_idx);
+        EXPECT_EQ(actual[i].DoG_value, expected[i].DoG_value);
+    }
+}
+
+// Runs the tasks back to front, the worst case for an order-dependent merge
+exec::Executor reversedExecutor() {
+    return [](int num_tasks, const std::function<void(int)>& task) {
+        for (int i = num_tasks - 1; i >= 0; --i) task(i);
+    };
+}
+
+TEST(CoarseKeypointDetectionTest, ParallelMatchesSerialTest) {
+    ss::ScaleSpace scale_space = {createRandomDoGOctave(150, 97, 5), createRandomDoGOctave(75, 49, 5)};
+    const float threshold = 1.0f;
+
+    std::vector<kp::KeyPoint> expected;
+    kp::coarseKeypointDetection(scale_space, expected, threshold);
+    ASSERT_FALSE(expected.empty());
+
+    for (const exec::Executor& executor : {exec::Executor(), exec::serialExecutor(), reversedExecutor()}) {
+        std::vector<kp::KeyPoint> keypoints;
+        kp::coarseKeypointDetection(scale_space, keypoints, threshold, executor);
+        expectIdenticalKeypoints(keypoints, expected);
+    }
+}
+
+TEST(CoarseKeypointDetectionTest, ParallelFixedPointMatchesSerialTest) {
+    ss::Pyramid DoG_pyramid(cv::Size(97, 150), 2, 5, CV_16S);
+    DoG_pyramid.setValueScale(100.0f);
+    for (int octave = 0; octave < 2; ++octave) {
+        cv::Size size = DoG_pyramid.octaveSize(octave);
+        ss::Octave values = createRandomDoGOctave(size.height, size.width, 5);
+        for (int level = 0; level < 5; ++level) {
+            ss::quantizeLevel(ss::viewOf<const float>(values[level]), DoG_pyramid.view<short>(octave, level), DoG_pyramid.valueScale());
+        }
+    }
+
+    std::vector<kp::KeyPoint> expected, keypoints;
+    kp::coarseKeypointDetection(DoG_pyramid, expected, 1.0f);
+    kp::coarseKeypointDetection(DoG_pyramid, keypoints, 1.0f, reversedExecutor());
+    ASSERT_FALSE(expected.empty());
+    expectIdenticalKeypoints(keypoints, expected);
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "keypointSet.hpp"
+#include "refine.hpp"
+#include "visualization.hpp"
+
+namespace {
+
+std::vector<kp::KeyPoint> createKeypoints(int count) {
+    std::vector<kp::KeyPoint> keypoints;
+    for (int i = 0; i < count; ++i) {
+        keypoints.push_back({float(i), float(2 * i), 1.0f + 0.1f * i, i % 3, 0.5f * i});
+    }
+    return keypoints;
+}
+
+}
+
+TEST(KeyPointSetTest, StoresAlignedFieldArrays) {
+    std::vector<kp::KeyPoint> keypoints = createKeypoints(19);
+    kp::KeyPointSet set(keypoints);
+
+    ASSERT_EQ(set.size(), keypoints.size());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(set.x()) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(set.DoGValue()) % 64, 0u);
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+        EXPECT_EQ(set.x()[i], keypoints[i].x);
+        EXPECT_EQ(set.y()[i], keypoints[i].y);
+        EXPECT_EQ(set.scaleIdx()[i], keypoints[i].scale_idx);
+        EXPECT_EQ(set.octaveIdx()[i], keypoints[i].octave_idx);
+        EXPECT_EQ(set[i].DoG_value, keypoints[i].DoG_value);
+        EXPECT_TRUE(set.isKept(i));
+    }
+}
+
+TEST(KeyPointSetTest, CompactKeepsOrderOfKeptKeypoints) {
+    std::vector<kp::KeyPoint> keypoints = createKeypoints(10);
+    kp::KeyPointSet set(keypoints);
+    for (size_t i : {0, 3, 4, 9}) set.reject(i);
+
+    EXPECT_EQ(set.compact(), 6u);
+    std::vector<kp::KeyPoint> kept = set.toVector();
+    ASSERT_EQ(kept.size(), 6u);
+    const int expected[] = {1, 2, 5, 6, 7, 8};
+    for (size_t i = 0; i < kept.size(); ++i) {
+        EXPECT_EQ(kept[i].x, keypoints[expected[i]].x);
+        EXPECT_EQ(kept[i].octave_idx, keypoints[expected[i]].octave_idx);
+        EXPECT_TRUE(set.isKept(i));
+    }
+}
+
+TEST(KeyPointSetTest, RefineMatchesSingleKeypointRefinement) {
+    ss::Octave octave;
+    for (int level = 0; level < 5; ++level) {
+        cv::Mat image(32, 32, CV_32F);
+        for (int row = 0; row < 32; ++row) {
+            for (int col = 0; col < 32; ++col) {
+                image.at<float>(row, col) = std::sin(0.7f * row + 0.3f * level) * std::cos(0.5f * col - 0.2f * level);
+            }
+        }
+        octave.push_back(image);
+    }
+    ss::ScaleSpace DoG = {octave};
+
+    std::vector<kp::KeyPoint> keypoints;
+    for (int row = 2; row < 30; row += 3) {
+        for (int col = 2; col < 30; col += 3) {
+            keypoints.push_back({float(col), float(row), 2.0f, 0, 0.0f});
+        }
+    }
+
+    std::vector<kp::KeyPoint> expected;
+    for (kp::KeyPoint keypoint : keypoints) {
+        refine::refineKeypoints(DoG, keypoint);
+        if (keypoint.x != -1e6 && keypoint.y != -1e6) expected.push_back(keypoint);
+    }
+
+    kp::KeyPointSet set(keypoints);
+    refine::refineKeypoints(DoG, set);
+    std::vector<kp::KeyPoint> refined = set.toVector();
+
+    ASSERT_LT(expected.size(), keypoints.size());
+    ASSERT_EQ(refined.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(refined[i].x, expected[i].x);
+        EXPECT_EQ(refined[i].y, expected[i].y);
+        EXPECT_EQ(refined[i].scale_idx, expected[i].scale_idx);
+    }
+}
+
+TEST(KeyPointSetTest, DrawSkipsRejectedKeypoints) {
+    cv::Mat image = cv::Mat::zeros(50, 50, CV_8UC3);
+    kp::KeyPointSet set(std::vector<kp::KeyPoint>{{10.0f, 10.0f, 1.0f, 0, 0.0f}, {40.0f, 40.0f, 1.0f, 0, 0.0f}});
+    set.reject(1);
+
+    cv::Mat output, expected;
+    vis::drawKeypoints(image, set, output, cv::Scalar(0, 255, 0), 1);
+    vis::drawKeypoints(image, std::vector<kp::KeyPoint>{set[0]}, expected, cv::Scalar(0, 255, 0), 1);
+
+    cv::Mat diff, gray_diff;
+    cv::absdiff(output, expected, diff);
+    cv::cvtColor(diff, gray_diff, cv::COLOR_BGR2GRAY);
+    EXPECT_EQ(cv::countNonZero(gray_diff), 0);
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include "pyramid.hpp"
+#include "dog.hpp"
+#include "keypointDetection.hpp"
+#include "refine.hpp"
+
+cv::Mat createPyramidTestImage(int rows, int cols) {
+    cv::Mat image(rows, cols, CV_32F);
+    cv::randu(image, 0.0, 255.0);
+    cv::GaussianBlur(image, image, cv::Size(0, 0), 1.0);
+    return image;
+}
+
+TEST(PyramidTest, OctaveSizesMatchResize) {
+    ss::Pyramid pyramid(cv::Size(75, 51), 4, 3);
+
+    cv::Mat level = cv::Mat::zeros(51, 75, CV_32F);
+    for (int octave = 0; octave < 4; ++octave) {
+        EXPECT_EQ(pyramid.octaveSize(octave), level.size());
+        cv::Mat next;
+        cv::resize(level, next, cv::Size(), 0.5, 0.5);
+        level = next;
+    }
+}
+
+TEST(PyramidTest, LevelsAreAlignedAndContiguous) {
+    ss::Pyramid pyramid(cv::Size(37, 20), 3, 4);
+
+    const auto* arena = static_cast<const unsigned char*>(pyramid.arena());
+    for (int octave = 0; octave < 3; ++octave) {
+        for (int level = 0; level < 4; ++level) {
+            auto view = pyramid.view(octave, level);
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(view.data) % ss::Pyramid::kAlignment, 0u);
+            EXPECT_EQ((view.stride * sizeof(float)) % ss::Pyramid::kAlignment, 0u);
+            EXPECT_GE(reinterpret_cast<const unsigned char*>(view.data), arena);
+            EXPECT_LE(reinterpret_cast<const unsigned char*>(view.row(view.rows - 1) + view.cols), arena + pyramid.bytes());
+            EXPECT_EQ(pyramid.mat(octave, level).data, reinterpret_cast<const unsigned char*>(view.data));
+        }
+    }
+}
+
+TEST(PyramidTest, ReallocatesOnlyWhenGeometryChanges) {
+    ss::Pyramid pyramid(cv::Size(32, 32), 2, 3);
+    const void* arena = pyramid.arena();
+
+    pyramid.allocate(cv::Size(32, 32), 2, 3);
+    EXPECT_EQ(pyramid.arena(), arena);
+
+    pyramid.allocate(cv::Size(64, 32), 2, 3);
+    EXPECT_EQ(pyramid.octaveSize(0), cv::Size(64, 32));
+}
+
+TEST(PyramidTest, RejectsInvalidGeometryAndViews) {
+    EXPECT_THROW(ss::Pyramid(cv::Size(0, 10), 1, 1), std::invalid_argument);
+    EXPECT_THROW(ss::Pyramid(cv::Size(4, 4), 5, 1), std::invalid_argument);
+
+    ss::Pyramid pyramid(cv::Size(8, 8), 1, 2);
+    EXPECT_THROW(pyramid.view(1, 0), std::out_of_range);
+    EXPECT_THROW(pyramid.view<short>(0, 0), std::invalid_argument);
+}
+
+TEST(PyramidTest, PipelineMatchesVectorScaleSpace) {
+    cv::Mat image = createPyramidTestImage(64, 80);
+
+    ss::ScaleSpace scale_space, DoG_scale_space;
+    ss::prepareScaleSpace(scale_space, image, 3, 3, 1.6f);
+    dog::calculateDifferenceOfGaussians(scale_space, DoG_scale_space);
+
+    ss::Pyramid pyramid, DoG_pyramid;
+    ss::prepareScaleSpace(pyramid, image, 3, 3, 1.6f);
+    dog::calculateDifferenceOfGaussians(pyramid, DoG_pyramid);
+
+    ASSERT_EQ(DoG_pyramid.numOctaves(), 3);
+    ASSERT_EQ(DoG_pyramid.levelsPerOctave(), 4);
+    for (int octave = 0; octave < 3; ++octave) {
+        for (int level = 0; level < 5; ++level) {
+            EXPECT_EQ(cv::norm(pyramid.mat(octave, level), scale_space[octave][level], cv::NORM_INF), 0.0);
+        }
+        for (int level = 0; level < 4; ++level) {
+            EXPECT_EQ(cv::norm(DoG_pyramid.mat(octave, level), DoG_scale_space[octave][level], cv::NORM_INF), 0.0);
+        }
+    }
+
+    std::vector<kp::KeyPoint> expected, keypoints;
+    kp::coarseKeypointDetection(DoG_scale_space, expected, 0.5f);
+    kp::coarseKeypointDetection(DoG_pyramid, keypoints, 0.5f);
+    ASSERT_EQ(keypoints.size(), expected.size());
+
+    for (size_t i = 0; i < keypoints.size(); ++i) {
+        kp::KeyPoint refined_expected = expected[i];
+        refine::refineKeypoints(DoG_scale_space, refined_expected);
+        refine::refineKeypoints(DoG_pyramid, keypoints[i]);
+        EXPECT_EQ(keypoints[i].x, refined_expected.x);
+        EXPECT_EQ(keypoints[i].y, refined_expected.y);
+    }
+}
+
+cv::Mat createPyramidBlobImage(int rows, int cols) {
+    cv::Mat image(rows, cols, CV_32F);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            float value = 40.0f;
+            for (int blob = 0; blob < 30; ++blob) {
+                float dx = col - (blob * 73) % cols;
+                float dy = row - (blob * 151) % rows;
+                float radius = 2.0f + blob % 5;
+                value += (blob % 2 ? 150.0f : -30.0f) * std::exp(-(dx * dx + dy * dy) / (2.0f * radius * radius));
+            }
+            image.at<float>(row, col) = value;
+        }
+    }
+    return image;
+}
+
+TEST(PyramidTest, QuantizeRoundTripsWithinHalfStep) {
+    cv::Mat image = createPyramidTestImage(20, 30);
+    ss::Pyramid fixed(image.size(), 1, 1, CV_16S), restored(image.size(), 1, 1);
+    const float scale = ss::kFixedPointRange / 255.0f;
+
+    ss::quantizeLevel(ss::viewOf<const float>(image), fixed.view<short>(0, 0), scale);
+    ss::dequantizeLevel(fixed.view<short>(0, 0), restored.view(0, 0), scale);
+    EXPECT_LE(cv::norm(image, restored.mat(0, 0), cv::NORM_INF), 0.5 / scale + 1e-5);
+}
+
+TEST(PyramidTest, FixedPointPyramidTracksFloat) {
+    cv::Mat image = createPyramidTestImage(64, 80);
+    ss::Pyramid pyramid, DoG_pyramid, fixed, fixed_DoG;
+    ss::prepareScaleSpace(pyramid, image, 3, 3, 1.6f);
+    dog::calculateDifferenceOfGaussians(pyramid, DoG_pyramid);
+
+    ss::ScaleSpaceOptions options;
+    options.storage_depth = CV_16S;
+    ss::prepareScaleSpace(fixed, image, 3, 3, 1.6f, options);
+    dog::calculateDifferenceOfGaussians(fixed, fixed_DoG);
+
+    ASSERT_EQ(fixed_DoG.depth(), CV_16S);
+    EXPECT_EQ(fixed_DoG.valueScale(), fixed.valueScale());
+    EXPECT_LT(fixed_DoG.bytes(), DoG_pyramid.bytes());
+
+    // Each Gaussian level is off by at most half a step, so a DoG sample by at most one
+    const float step = 1.0f / fixed.valueScale();
+    for (int octave = 0; octave < 3; ++octave) {
+        for (int level = 0; level < 4; ++level) {
+            ss::Pyramid widened(fixed_DoG.octaveSize(octave), 1, 1);
+            ss::dequantizeLevel(fixed_DoG.view<short>(octave, level), widened.view(0, 0), fixed_DoG.valueScale());
+            EXPECT_LE(cv::norm(widened.mat(0, 0), DoG_pyramid.mat(octave, level), cv::NORM_INF), step + 1e-4);
+        }
+    }
+}
+
+TEST(PyramidTest, FixedPointKeypointsAgreeWithFloat) {
+    cv::Mat image = createPyramidBlobImage(128, 160);
+    ss::Pyramid pyramid, DoG_pyramid, fixed, fixed_DoG;
+    ss::prepareScaleSpace(pyramid, image, 3, 3, 1.6f);
+    dog::calculateDifferenceOfGaussians(pyramid, DoG_pyramid);
+
+    ss::ScaleSpaceOptions options;
+    options.storage_depth = CV_16S;
+    ss::prepareScaleSpace(fixed, image, 3, 3, 1.6f, options);
+    dog::calculateDifferenceOfGaussians(fixed, fixed_DoG);
+
+    std::vector<kp::KeyPoint> expected, keypoints;
+    kp::coarseKeypointDetection(DoG_pyramid, expected, 0.5f);
+    kp::coarseKeypointDetection(fixed_DoG, keypoints, 0.5f);
+    ASSERT_FALSE(expected.empty());
+
+    // Quantization turns some near-ties on flat extrema into equal samples, which the strict comparison
+    // drops; it should not invent extrema, and refinement should land on nearly the same point.
+    int matched = 0, same_decision = 0;
+    for (kp::KeyPoint candidate : keypoints) {
+        for (kp::KeyPoint reference : expected) {
+            if (candidate.octave_idx != reference.octave_idx || candidate.scale_idx != reference.scale_idx ||
+                candidate.x != reference.x || candidate.y != reference.y) {
+                continue;
+            }
+            matched++;
+            EXPECT_NEAR(candidate.DoG_value, reference.DoG_value, 1.0f / fixed_DoG.valueScale());
+
+            refine::refineKeypoints(DoG_pyramid, reference);
+            refine::refineKeypoints(fixed_DoG, candidate);
+            bool reference_kept = reference.x != -1e6 && reference.y != -1e6;
+            bool candidate_kept = candidate.x != -1e6 && candidate.y != -1e6;
+            if (reference_kept == candidate_kept) same_decision++;
+            if (reference_kept && candidate_kept) {
+                const float tolerance = 0.3f * (1 << reference.octave_idx);
+                EXPECT_NEAR(candidate.x, reference.x, tolerance);
+                EXPECT_NEAR(candidate.y, reference.y, tolerance);
+            }
+            break;
+        }
+    }
+
+    EXPECT_GE(matched, 0.9 * keypoints.size());
+    EXPECT_GE(keypoints.size(), 0.75 * expected.size());
+    EXPECT_GE(same_decision, 0.8 * matched);
+}
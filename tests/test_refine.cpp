@@ -123,3 +123,223 @@ TEST(KeypointRefinementTest, CalculatesCorrectGradients) {
     EXPECT_NEAR(gradients[1], 0.0f, 1e-5f);
     EXPECT_NEAR(gradients[2], 0.5f * (6.0f - 5.0f), 1e-5f); // 0.5
 }
+
+TEST(KeypointRefinementTest, StencilMatchesPerSampleAccess) {
+    ss::ScaleSpace ss(1, ss::Octave(4));
+    for (int level = 0; level < 4; ++level) {
+        ss[0][level] = cv::Mat(6, 7, CV_32F);
+        cv::randu(ss[0][level], -1.0, 1.0);
+    }
+
+    for (kp::KeyPoint kp : {kp::KeyPoint{3.3f, 2.6f, 1.4f, 0}, kp::KeyPoint{0.2f, 5.0f, 2.0f, 0}, kp::KeyPoint{6.0f, 0.0f, 3.0f, 0}}) {
+        refine::Stencil stencil = refine::loadStencil(ss, kp);
+        for (int ds = -1; ds <= 1; ++ds) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    kp::KeyPoint neighbour{kp.x + dx, kp.y + dy, kp.scale_idx + ds, 0};
+                    float expected = 0.0f;
+                    try {
+                        expected = refine::accessScaleSpace(ss, neighbour);
+                    } catch (const std::out_of_range&) {}
+                    EXPECT_EQ(stencil[ds + 1][dy + 1][dx + 1], expected);
+                }
+            }
+        }
+    }
+}
+
+TEST(MatUtilsTest, FixedSizeInverseIsInverse) {
+    refine::Mat3 m = {{{1.3f, 4.77f, 5.89f}, {5.73f, 6.32f, -7.23f}, {-1.342f, 8.88f, -9.0f}}};
+    refine::Mat3 inv = refine::inverse(m);
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            float sum = 0.0f;
+            for (int k = 0; k < 3; ++k) sum += m[i][k] * inv[k][j];
+            EXPECT_NEAR(sum, i == j ? 1.0f : 0.0f, 1e-5f);
+        }
+    }
+
+    EXPECT_EQ(refine::inverse(refine::Mat3{}), refine::Mat3{});
+}
+
+TEST(KeypointRefinementTest, BatchMatchesScalarRefinement) {
+    // Two octaves of smooth random DoG levels, with a candidate at every interior sample of each scale
+    ss::ScaleSpace DoG(2, ss::Octave(5));
+    for (int octave = 0; octave < 2; ++octave) {
+        for (int level = 0; level < 5; ++level) {
+            cv::Mat noise(24 >> octave, 40 >> octave, CV_32F);
+            cv::randu(noise, -1.0, 1.0);
+            cv::GaussianBlur(noise, DoG[octave][level], cv::Size(0, 0), 1.0);
+        }
+    }
+
+    std::vector<kp::KeyPoint> candidates;
+    for (int octave = 0; octave < 2; ++octave) {
+        for (int level = 0; level < 5; ++level) {
+            for (int row = 1; row < DoG[octave][0].rows - 1; ++row) {
+                for (int col = 1; col < DoG[octave][0].cols - 1; ++col) {
+                    candidates.push_back({float(col << octave), float(row << octave), float(level), octave, 0.0f});
+                }
+            }
+        }
+    }
+
+    kp::KeyPointSet scalar(candidates), batched(candidates);
+    refine::refineKeypoints(DoG, scalar);
+    refine::refineKeypointsBatch(DoG, batched);
+
+    ASSERT_GT(scalar.size(), 0u);
+    ASSERT_EQ(batched.size(), scalar.size());
+    for (size_t i = 0; i < scalar.size(); ++i) {
+        EXPECT_NEAR(batched.x()[i], scalar.x()[i], 1e-4f);
+        EXPECT_NEAR(batched.y()[i], scalar.y()[i], 1e-4f);
+        EXPECT_NEAR(batched.scaleIdx()[i], scalar.scaleIdx()[i], 1e-4f);
+        EXPECT_EQ(batched.octaveIdx()[i], scalar.octaveIdx()[i]);
+    }
+}
+
+namespace {
+
+// DoG octave sampling one smooth negative blob centred at (cx, cy, cs)
+ss::ScaleSpace createBlobDoG(float cx, float cy, float cs) {
+    ss::ScaleSpace DoG(1, ss::Octave(5));
+    for (int level = 0; level < 5; ++level) {
+        DoG[0][level] = cv::Mat(24, 24, CV_32F);
+        for (int row = 0; row < 24; ++row) {
+            for (int col = 0; col < 24; ++col) {
+                float r2 = (col - cx) * (col - cx) + (row - cy) * (row - cy);
+                DoG[0][level].at<float>(row, col) = -std::exp(-r2 / 50.0f - (level - cs) * (level - cs) / 2.0f);
+            }
+        }
+    }
+    return DoG;
+}
+
+}
+
+TEST(KeypointRefinementTest, IterativeLocalizationConvergesAndDeduplicates) {
+    ss::ScaleSpace DoG = createBlobDoG(10.3f, 12.6f, 2.2f);
+
+    // Candidates up to two samples away from the extremum, most needing more than one step
+    std::vector<kp::KeyPoint> candidates;
+    for (int dy = -2; dy <= 2; ++dy) {
+        for (int dx = -2; dx <= 2; ++dx) {
+            if (std::abs(dx) + std::abs(dy) > 2) continue;
+            candidates.push_back({10.0f + dx, 13.0f + dy, 2.0f, 0, 0.0f});
+        }
+    }
+
+    kp::KeyPointSet keypoints(candidates);
+    refine::LocalizationStats stats;
+    refine::localizeKeypoints(DoG, keypoints, {}, 1.0f, &stats);
+
+    ASSERT_EQ(keypoints.size(), 1u);
+    EXPECT_NEAR(keypoints.x()[0], 10.3f, 0.15f);
+    EXPECT_NEAR(keypoints.y()[0], 12.6f, 0.15f);
+    EXPECT_NEAR(keypoints.scaleIdx()[0], 2.2f, 0.15f);
+    EXPECT_LT(keypoints.DoGValue()[0], -0.9f);
+    EXPECT_EQ(stats.duplicates, static_cast<int>(candidates.size()) - 1);
+    EXPECT_GT(stats.moves, 0);
+    EXPECT_GT(stats.cache_hits, 0);
+
+    // With a single fit, only candidates already at the extremum's sample survive
+    refine::LocalizationOptions single_step;
+    single_step.max_iterations = 1;
+    single_step.remove_duplicates = false;
+    kp::KeyPointSet one_step(candidates);
+    refine::localizeKeypoints(DoG, one_step, single_step);
+    EXPECT_EQ(one_step.size(), 1u);
+
+    EXPECT_THROW(refine::localizeKeypoints(DoG, one_step, {0}), std::invalid_argument);
+}
+
+TEST(KeypointRefinementTest, IterativeLocalizationRejectsFarOffsets) {
+    // Steep x gradient with no x curvature and a small x-scale cross term: |det H| = dxs^2 passes the
+    // singularity test, but the fitted x offset is about 8e9 samples, far outside int range
+    ss::ScaleSpace DoG(1);
+    for (int level = 0; level < 3; ++level) DoG[0].push_back(cv::Mat::zeros(9, 9, CV_32F));
+    DoG[0][1].at<float>(4, 5) = 1e4f;
+    DoG[0][1].at<float>(4, 3) = -1e4f;
+    DoG[0][1].at<float>(3, 4) = 0.5f;
+    DoG[0][1].at<float>(5, 4) = 0.5f;
+    DoG[0][0].at<float>(4, 4) = 0.5f;
+    DoG[0][2].at<float>(4, 4) = 0.5f;
+    DoG[0][2].at<float>(4, 5) = 4.4e-3f;
+
+    kp::KeyPointSet keypoints({{4.0f, 4.0f, 1.0f, 0, 0.0f}});
+    refine::LocalizationStats stats;
+    refine::localizeKeypoints(DoG, keypoints, {}, 1.0f, &stats);
+
+    EXPECT_EQ(keypoints.size(), 0u);
+    EXPECT_EQ(stats.moves, 0);
+}
+
+TEST(KeypointRefinementTest, DetectAndRefineMatchesTwoPass) {
+    ss::ScaleSpace DoG(2, ss::Octave(5));
+    for (int octave = 0; octave < 2; ++octave) {
+        for (int level = 0; level < 5; ++level) {
+            cv::Mat noise(90 >> octave, 70 >> octave, CV_32F);
+            cv::randu(noise, -1.0, 1.0);
+            cv::GaussianBlur(noise, DoG[octave][level], cv::Size(0, 0), 1.0);
+        }
+    }
+    const float threshold = 0.01f;
+
+    std::vector<kp::KeyPoint> candidates;
+    kp::coarseKeypointDetection(DoG, candidates, threshold);
+    kp::KeyPointSet expected(candidates);
+    refine::refineKeypoints(DoG, expected);
+    ASSERT_GT(expected.size(), 0u);
+
+    // Bands run back to front to make sure the output order does not depend on the schedule
+    exec::Executor reversed = [](int num_tasks, const std::function<void(int)>& task) {
+        for (int i = num_tasks - 1; i >= 0; --i) task(i);
+    };
+    for (const exec::Executor& executor : {exec::Executor(), reversed}) {
+        kp::KeyPointSet fused;
+        refine::detectAndRefine(DoG, threshold, fused, executor);
+        ASSERT_EQ(fused.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(fused.x()[i], expected.x()[i]);
+            EXPECT_EQ(fused.y()[i], expected.y()[i]);
+            EXPECT_EQ(fused.scaleIdx()[i], expected.scaleIdx()[i]);
+            EXPECT_EQ(fused.octaveIdx()[i], expected.octaveIdx()[i]);
+        }
+    }
+}
+
+TEST(KeypointRefinementTest, ThresholdsComeFromConfig) {
+    // One elongated extremum, a third of a sample off the grid in x
+    ss::ScaleSpace DoG(1, ss::Octave(5));
+    for (int level = 0; level < 5; ++level) {
+        DoG[0][level] = cv::Mat(24, 24, CV_32F);
+        for (int row = 0; row < 24; ++row) {
+            for (int col = 0; col < 24; ++col) {
+                float r2 = (col - 12.3f) * (col - 12.3f) / 72.0f + (row - 11.9f) * (row - 11.9f) / 2.0f;
+                DoG[0][level].at<float>(row, col) = -std::exp(-r2 - (level - 2.1f) * (level - 2.1f) / 2.0f);
+            }
+        }
+    }
+    std::vector<kp::KeyPoint> candidates;
+    kp::coarseKeypointDetection(DoG, candidates, 0.01f);
+    ASSERT_FALSE(candidates.empty());
+
+    kp::KeyPointSet loose(candidates), strict(candidates), strict_batch(candidates), tight(candidates);
+    refine::refineKeypoints(DoG, loose);
+    ASSERT_GT(loose.size(), 0u);
+
+    cfg::SiftConfig config;
+    config.contrast_threshold = 100.0f;
+    refine::refineKeypoints(DoG, strict, 1.0f, config);
+    refine::refineKeypointsBatch(DoG, strict_batch, 1.0f, config);
+    EXPECT_EQ(strict.size(), 0u);
+    EXPECT_EQ(strict_batch.size(), 0u);
+
+    // The refined offset exceeds a quarter sample, so a tighter offset limit rejects it
+    config = {};
+    config.offset_limit = 0.25f;
+    refine::refineKeypoints(DoG, tight, 1.0f, config);
+    EXPECT_LT(tight.size(), loose.size());
+
+    EXPECT_EQ(refine::localizationOptions(config).contrast_threshold, config.contrast_threshold);
+}
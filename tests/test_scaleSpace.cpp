@@ -28,3 +28,66 @@ TEST(ScaleSpaceTest, PrepareScaleSpaceImageCheck) {
         EXPECT_EQ(octave.size(), 5); // 3 + 2 = 5 images
     }
 }
+
+TEST(ScaleSpaceTest, DirectFromBaseMatchesIncremental) {
+    cv::Mat image(64, 80, CV_32F);
+    cv::randu(image, 0.0, 255.0);
+
+    ss::ScaleSpace incremental, direct;
+    ss::ScaleSpaceOptions options;
+    ss::prepareScaleSpace(incremental, image, 3, 3, 1.6, options);
+
+    options.mode = ss::ConstructionMode::DirectFromBase;
+    ss::prepareScaleSpace(direct, image, 3, 3, 1.6, options);
+
+    ASSERT_EQ(direct.size(), incremental.size());
+    for (size_t octave = 0; octave < direct.size(); ++octave) {
+        ASSERT_EQ(direct[octave].size(), incremental[octave].size());
+        for (size_t level = 0; level < direct[octave].size(); ++level) {
+            ASSERT_EQ(direct[octave][level].size(), incremental[octave][level].size());
+            // Blurring once with the absolute sigma only differs from the chain by kernel truncation
+            EXPECT_LT(cv::norm(direct[octave][level], incremental[octave][level], cv::NORM_INF), 1.0);
+        }
+    }
+}
+
+TEST(ScaleSpaceTest, DirectFromBaseOctaveFillsAllLevels) {
+    cv::Mat image = cv::Mat::ones(32, 32, CV_32F);
+    ss::Octave octave;
+    ss::ScaleSpaceOptions options;
+    options.mode = ss::ConstructionMode::DirectFromBase;
+    options.blur_backend = blur::Backend::Separable;
+
+    ss::prepareOctave(octave, image, 1.6, 3, options);
+
+    ASSERT_EQ(octave.size(), 5);
+    for (const auto& level : octave) {
+        ASSERT_FALSE(level.empty());
+        EXPECT_NEAR(level.at<float>(16, 16), 1.0f, 1e-5);
+    }
+}
+
+TEST(ScaleSpaceTest, RecursiveBackendAboveSigmaCutoff) {
+    ss::ScaleSpaceOptions options;
+    options.recursive_sigma_cutoff = 2.0f;
+    EXPECT_EQ(ss::selectBlurBackend(options, 1.5f), blur::Backend::OpenCV);
+    EXPECT_EQ(ss::selectBlurBackend(options, 2.5f), blur::Backend::Recursive);
+
+    cv::Mat image(48, 48, CV_32F);
+    cv::randu(image, 0.0, 255.0);
+    ss::Octave octave;
+    options.mode = ss::ConstructionMode::DirectFromBase;
+    ss::prepareOctave(octave, image, 1.6, 3, options);
+
+    // Levels 3 and 4 are blurred from the base with sigma above 2
+    for (int level = 1; level < 5; ++level) {
+        float delta = ss::computeDeltaSigma(1.6f, ss::computeSigmaForLevel(1.6f, level, 3));
+        cv::Mat expected;
+        blur::gaussianBlur(image, expected, delta, ss::selectBlurBackend(options, delta));
+        EXPECT_EQ(cv::norm(octave[level], expected, cv::NORM_INF), 0.0) << "level " << level;
+    }
+
+    cv::Mat exact;
+    blur::gaussianBlur(image, exact, ss::computeDeltaSigma(1.6f, ss::computeSigmaForLevel(1.6f, 4, 3)), blur::Backend::OpenCV);
+    EXPECT_GT(cv::norm(octave[4], exact, cv::NORM_INF), 0.0);
+}
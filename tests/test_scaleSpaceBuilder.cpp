@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include "scaleSpaceBuilder.hpp"
+#include "dog.hpp"
+
+cv::Mat createBuilderTestFrame(int rows, int cols, double seed_offset) {
+    cv::Mat frame(rows, cols, CV_32F);
+    cv::randu(frame, 0.0, 255.0);
+    frame += seed_offset;
+    return frame;
+}
+
+TEST(ScaleSpaceBuilderTest, DownsampleByTwoMatchesResize) {
+    cv::Mat image = createBuilderTestFrame(15, 22, 0.0);
+    ss::Pyramid pyramid(cv::Size(22, 15), 2, 1);
+    image.copyTo(pyramid.scaleSpace()[0][0]);
+
+    ss::downsampleByTwo(pyramid.view(0, 0), pyramid.view(1, 0));
+
+    cv::Mat expected;
+    cv::resize(image, expected, cv::Size(), 0.5, 0.5);
+    ASSERT_EQ(expected.size(), pyramid.octaveSize(1));
+    EXPECT_LT(cv::norm(expected, pyramid.mat(1, 0), cv::NORM_INF), 1e-3);
+}
+
+TEST(ScaleSpaceBuilderTest, MatchesPrepareScaleSpace) {
+    cv::Mat frame = createBuilderTestFrame(64, 80, 0.0);
+    ss::ScaleSpaceBuilder builder(frame.size(), 3, 3, 1.6f);
+    builder.build(frame);
+
+    ss::ScaleSpaceOptions options;
+    options.blur_backend = blur::Backend::Separable;
+    ss::Pyramid expected, expected_DoG;
+    ss::prepareScaleSpace(expected, frame, 3, 3, 1.6f, options);
+    dog::calculateDifferenceOfGaussians(expected, expected_DoG);
+
+    for (int octave = 0; octave < 3; ++octave) {
+        for (int level = 0; level < 5; ++level) {
+            EXPECT_LT(cv::norm(builder.gaussianPyramid().mat(octave, level), expected.mat(octave, level), cv::NORM_INF), 1e-2);
+        }
+        for (int level = 0; level < 4; ++level) {
+            EXPECT_LT(cv::norm(builder.DoGPyramid().mat(octave, level), expected_DoG.mat(octave, level), cv::NORM_INF), 1e-2);
+        }
+    }
+}
+
+TEST(ScaleSpaceBuilderTest, RejectsMismatchedFrames) {
+    ss::ScaleSpaceBuilder builder(cv::Size(32, 32), 2, 3, 1.6f);
+    EXPECT_THROW(builder.build(cv::Mat::zeros(16, 32, CV_32F)), std::invalid_argument);
+    EXPECT_THROW(builder.build(cv::Mat::zeros(32, 32, CV_8U)), std::invalid_argument);
+    EXPECT_THROW(ss::ScaleSpaceBuilder(cv::Size(32, 32), 0, 3, 1.6f), std::invalid_argument);
+}
+
+TEST(ScaleSpaceBuilderTest, FusedModeMatchesFullPyramidDoG) {
+    cv::Mat frame = createBuilderTestFrame(72, 90, 0.0);
+
+    for (int scales : {2, 3}) {
+        ss::ScaleSpaceBuilder full(frame.size(), 3, scales, 1.6f, true);
+        ss::ScaleSpaceBuilder fused(frame.size(), 3, scales, 1.6f, false);
+        full.build(frame);
+        fused.build(frame);
+
+        EXPECT_TRUE(fused.gaussianPyramid().empty());
+        EXPECT_LT(fused.bytes(), full.bytes() * 2 / 3);
+
+        for (int octave = 0; octave < 3; ++octave) {
+            for (int level = 0; level < scales + 1; ++level) {
+                EXPECT_EQ(cv::norm(fused.DoGPyramid().mat(octave, level), full.DoGPyramid().mat(octave, level), cv::NORM_INF), 0.0)
+                    << "scales " << scales << " octave " << octave << " level " << level;
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <opencv2/opencv.hpp>
+#include "scaleSpaceBuilder.hpp"
+
+// Built as its own executable (test_allocations): these replacements reroute every allocation in the binary,
+// gtest and OpenCV included, so they must not leak into test_aux.
+static std::atomic<long> allocation_count{0};
+
+static void* countedAllocation(std::size_t size, std::size_t alignment) {
+    allocation_count++;
+    size = size ? size : 1;
+    void* ptr = alignment <= alignof(std::max_align_t) ? std::malloc(size)
+                                                       : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+// Not inlined, so GCC does not pair this free with the operator new of the caller's new-expression
+__attribute__((noinline)) static void countedRelease(void* ptr) noexcept { std::free(ptr); }
+
+void* operator new(std::size_t size) { return countedAllocation(size, 0); }
+void* operator new[](std::size_t size) { return countedAllocation(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAllocation(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAllocation(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* ptr) noexcept { countedRelease(ptr); }
+void operator delete[](void* ptr) noexcept { countedRelease(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { countedRelease(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { countedRelease(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { countedRelease(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { countedRelease(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { countedRelease(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { countedRelease(ptr); }
+
+static cv::Mat createAllocationTestFrame(int rows, int cols, double seed_offset) {
+    cv::Mat frame(rows, cols, CV_32F);
+    cv::randu(frame, 0.0, 255.0);
+    frame += seed_offset;
+    return frame;
+}
+
+TEST(ScaleSpaceBuilderAllocationTest, SteadyStateBuildDoesNotAllocate) {
+    std::vector<cv::Mat> frames;
+    for (int i = 0; i < 3; ++i) {
+        frames.push_back(createAllocationTestFrame(96, 128, i));
+    }
+
+    ss::ScaleSpaceBuilder builder(frames[0].size(), 4, 5, 1.6f);
+    builder.build(frames[0]);  // warm-up
+
+    const void* gaussian_arena = builder.gaussianPyramid().arena();
+    const void* DoG_arena = builder.DoGPyramid().arena();
+
+    long before = allocation_count.load();
+    for (const cv::Mat& frame : frames) {
+        builder.build(frame);
+    }
+    long allocations = allocation_count.load() - before;
+
+    EXPECT_EQ(allocations, 0);
+    EXPECT_EQ(builder.gaussianPyramid().arena(), gaussian_arena);
+    EXPECT_EQ(builder.DoGPyramid().arena(), DoG_arena);
+}
+
+TEST(ScaleSpaceBuilderAllocationTest, FusedModeDoesNotAllocate) {
+    cv::Mat frame = createAllocationTestFrame(64, 64, 0.0);
+    ss::ScaleSpaceBuilder builder(frame.size(), 3, 3, 1.6f, false);
+    builder.build(frame);
+
+    long before = allocation_count.load();
+    builder.build(frame);
+    EXPECT_EQ(allocation_count.load() - before, 0);
+}
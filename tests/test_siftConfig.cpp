@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include "siftConfig.hpp"
+
+TEST(SiftConfigTest, DefaultsAreValid) {
+    cfg::SiftConfig config;
+    EXPECT_NO_THROW(config.validate());
+    EXPECT_EQ(config.num_angle_bins, 8);
+    EXPECT_EQ(config.num_radius_bins, 4);
+}
+
+TEST(SiftConfigTest, RejectsInvalidValues) {
+    cfg::SiftConfig config;
+    config.scales_per_octave = 0;
+    EXPECT_THROW(config.validate(), std::invalid_argument);
+
+    config = {};
+    config.contrast_threshold = 0.0f;
+    EXPECT_THROW(config.validate(), std::invalid_argument);
+
+    config = {};
+    config.edge_threshold = 0.0f;
+    EXPECT_THROW(config.validate(), std::invalid_argument);
+
+    config = {};
+    config.num_radius_bins = -1;
+    EXPECT_THROW(config.validate(), std::invalid_argument);
+}
+
+TEST(SiftConfigTest, NumOctavesFollowsImageSize) {
+    cfg::SiftConfig config;
+    EXPECT_EQ(config.numOctavesFor(cv::Size(512, 256)), 5);
+    EXPECT_EQ(config.numOctavesFor(cv::Size(8, 8)), 1);
+    config.num_octaves = 3;
+    EXPECT_EQ(config.numOctavesFor(cv::Size(512, 256)), 3);
+}
+
+TEST(SiftConfigTest, DispatchFixedSelectsSpecialization) {
+    auto selected = [](int value) { return cfg::dispatchFixed<3, 5>(value, [](auto fixed) { return fixed(); }); };
+    EXPECT_EQ(selected(3), 3);
+    EXPECT_EQ(selected(5), 5);
+    EXPECT_EQ(selected(4), 0);
+}
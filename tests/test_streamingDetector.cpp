@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "scaleSpaceBuilder.hpp"
+#include "keypointDetection.hpp"
+#include "refine.hpp"
+#include "streamingDetector.hpp"
+
+cv::Mat createStreamingTestFrame(int rows, int cols) {
+    cv::Mat frame(rows, cols, CV_32F);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            float value = 40.0f;
+            for (int blob = 0; blob < 30; ++blob) {
+                float dx = col - (blob * 73) % cols;
+                float dy = row - (blob * 151) % rows;
+                float radius = 2.0f + blob % 5;
+                value += (blob % 2 ? 150.0f : -30.0f) * std::exp(-(dx * dx + dy * dy) / (2.0f * radius * radius));
+            }
+            frame.at<float>(row, col) = value;
+        }
+    }
+    return frame;
+}
+
+void expectSameKeypoints(const std::vector<kp::KeyPoint>& result, const std::vector<kp::KeyPoint>& expected) {
+    ASSERT_EQ(result.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(result[i].x, expected[i].x);
+        EXPECT_EQ(result[i].y, expected[i].y);
+        EXPECT_EQ(result[i].scale_idx, expected[i].scale_idx);
+        EXPECT_EQ(result[i].octave_idx, expected[i].octave_idx);
+        EXPECT_EQ(result[i].DoG_value, expected[i].DoG_value);
+    }
+}
+
+TEST(StreamingDetectorTest, MatchesCoarseDetectionOnFullPyramid) {
+    cv::Mat frame = createStreamingTestFrame(96, 120);
+    ss::ScaleSpaceBuilder builder(frame.size(), 3, 3, 1.6f, false);
+    builder.build(frame);
+    std::vector<kp::KeyPoint> expected;
+    kp::coarseKeypointDetection(builder.DoGPyramid(), expected, 0.04f);
+
+    kp::StreamingDetector detector(frame.size(), 3, 3, 1.6f, 0.04f);
+    std::vector<kp::KeyPoint> keypoints;
+    detector.detect(frame, keypoints);
+
+    ASSERT_FALSE(expected.empty());
+    expectSameKeypoints(keypoints, expected);
+
+    // Three DoG and two Gaussian frame-sized slots, against S + 1 DoG levels per octave
+    EXPECT_LT(detector.bytes(), builder.DoGPyramid().bytes());
+}
+
+TEST(StreamingDetectorTest, RefinesWhileTripleIsResident) {
+    cv::Mat frame = createStreamingTestFrame(96, 120);
+    ss::ScaleSpaceBuilder builder(frame.size(), 3, 3, 1.6f, false);
+    builder.build(frame);
+    std::vector<kp::KeyPoint> candidates, expected;
+    kp::coarseKeypointDetection(builder.DoGPyramid(), candidates, 0.04f);
+    for (kp::KeyPoint& keypoint : candidates) {
+        refine::refineKeypoints(builder.DoGPyramid(), keypoint);
+        if (keypoint.x != -1e6 && keypoint.y != -1e6) expected.push_back(keypoint);
+    }
+
+    kp::StreamingDetector detector(frame.size(), 3, 3, 1.6f, 0.04f, true);
+    std::vector<kp::KeyPoint> keypoints;
+    detector.detect(frame, keypoints);
+    expectSameKeypoints(keypoints, expected);
+
+    // A second frame reuses the ring without carrying anything over
+    keypoints.clear();
+    detector.detect(frame, keypoints);
+    expectSameKeypoints(keypoints, expected);
+}
+
+TEST(StreamingDetectorTest, RejectsInvalidArguments) {
+    EXPECT_THROW(kp::StreamingDetector(cv::Size(32, 32), 0, 3, 1.6f, 0.04f), std::invalid_argument);
+    EXPECT_THROW(kp::StreamingDetector(cv::Size(4, 4), 8, 3, 1.6f, 0.04f), std::invalid_argument);
+
+    kp::StreamingDetector detector(cv::Size(32, 32), 2, 3, 1.6f, 0.04f);
+    std::vector<kp::KeyPoint> keypoints;
+    EXPECT_THROW(detector.detect(cv::Mat::zeros(16, 32, CV_32F), keypoints), std::invalid_argument);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include "scaleSpaceBuilder.hpp"
+#include "keypointDetection.hpp"
+#include "refine.hpp"
+#include "tiledExtraction.hpp"
+
+// Deterministic bright and dark blobs of a few sizes, so there are stable extrema in both octaves and on tile seams.
+cv::Mat createTilingTestImage(int rows, int cols) {
+    cv::Mat image(rows, cols, CV_8U);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            double value = 40.0;
+            for (int blob = 0; blob < 40; ++blob) {
+                double dx = col - (blob * 73) % cols;
+                double dy = row - (blob * 151) % rows;
+                double radius = 2.0 + blob % 5;
+                value += (blob % 2 ? 150.0 : -30.0) * std::exp(-(dx * dx + dy * dy) / (2.0 * radius * radius));
+            }
+            image.at<uchar>(row, col) = cv::saturate_cast<uchar>(value);
+        }
+    }
+    return image;
+}
+
+std::vector<kp::KeyPoint> extractFullImageKeypoints(const cv::Mat& image, const tile::TilingOptions& options) {
+    cv::Mat input;
+    image.convertTo(input, CV_32F);
+
+    ss::ScaleSpaceBuilder builder(input.size(), options.num_octaves, options.scales_per_octave, options.initial_scale, false);
+    builder.build(input);
+
+    std::vector<kp::KeyPoint> candidates, keypoints;
+    kp::coarseKeypointDetection(builder.DoGPyramid(), candidates, options.contrast_threshold);
+    for (kp::KeyPoint& keypoint : candidates) {
+        refine::refineKeypoints(builder.DoGPyramid(), keypoint);
+        if (keypoint.x != -1e6 && keypoint.y != -1e6) {
+            keypoints.push_back(keypoint);
+        }
+    }
+    return keypoints;
+}
+
+void sortKeypoints(std::vector<kp::KeyPoint>& keypoints) {
+    std::sort(keypoints.begin(), keypoints.end(), [](const kp::KeyPoint& a, const kp::KeyPoint& b) {
+        return std::make_tuple(a.octave_idx, std::round(a.y), std::round(a.x), a.scale_idx) <
+               std::make_tuple(b.octave_idx, std::round(b.y), std::round(b.x), b.scale_idx);
+    });
+}
+
+tile::TilingOptions createTilingTestOptions() {
+    tile::TilingOptions options;
+    options.num_octaves = 2;
+    options.scales_per_octave = 3;
+    options.max_parallel_tiles = 3;
+    return options;
+}
+
+TEST(TiledExtractionTest, HaloIsAlignedToCoarsestOctave) {
+    for (int octaves = 1; octaves <= 4; ++octaves) {
+        int halo = tile::computeHalo(octaves, 3, 1.6f);
+        EXPECT_GT(halo, 0);
+        EXPECT_EQ(halo % (1 << octaves), 0);
+    }
+    EXPECT_GT(tile::computeHalo(3, 3, 1.6f), tile::computeHalo(2, 3, 1.6f));
+}
+
+TEST(TiledExtractionTest, TileCoresPartitionTheImage) {
+    cv::Size image_size(250, 170);
+    std::vector<tile::Tile> tiles = tile::planTiles(image_size, 64, 16);
+
+    cv::Mat coverage = cv::Mat::zeros(image_size.height, image_size.width, CV_32F);
+    for (const tile::Tile& t : tiles) {
+        EXPECT_EQ(t.core & t.padded, t.core);
+        EXPECT_LE(t.padded.x + t.padded.width, image_size.width);
+        EXPECT_LE(t.padded.y + t.padded.height, image_size.height);
+        cv::Mat core_coverage = coverage(t.core);
+        core_coverage += 1.0;
+    }
+    EXPECT_EQ(tiles.size(), 4u * 3u);
+    EXPECT_EQ(cv::norm(coverage, cv::Mat::ones(image_size.height, image_size.width, CV_32F), cv::NORM_INF), 0.0);
+}
+
+TEST(TiledExtractionTest, MatchesFullImageExtraction) {
+    cv::Mat image = createTilingTestImage(230, 290);
+    tile::TilingOptions options = createTilingTestOptions();
+
+    // Small enough budget to force a 3 x 4 grid of 80-pixel cores
+    int halo = tile::computeHalo(options.num_octaves, options.scales_per_octave, options.initial_scale);
+    options.memory_budget_bytes = options.max_parallel_tiles *
+        tile::estimateTileBytes(cv::Size(80 + 2 * halo, 80 + 2 * halo), options.num_octaves, options.scales_per_octave);
+
+    std::vector<kp::KeyPoint> tiled;
+    tile::extractKeypointsTiled(image, options, tiled);
+    std::vector<kp::KeyPoint> expected = extractFullImageKeypoints(image, options);
+
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(tiled.size(), expected.size());
+
+    sortKeypoints(tiled);
+    sortKeypoints(expected);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(tiled[i].octave_idx, expected[i].octave_idx);
+        EXPECT_NEAR(tiled[i].x, expected[i].x, 1e-3);
+        EXPECT_NEAR(tiled[i].y, expected[i].y, 1e-3);
+        EXPECT_NEAR(tiled[i].scale_idx, expected[i].scale_idx, 1e-4);
+        EXPECT_EQ(tiled[i].DoG_value, expected[i].DoG_value);
+    }
+}
+
+TEST(TiledExtractionTest, ReaderMatchesInMemoryImage) {
+    cv::Mat image = createTilingTestImage(150, 170);
+    cv::Mat image_16U;
+    image.convertTo(image_16U, CV_16U);
+
+    tile::TilingOptions options = createTilingTestOptions();
+    options.memory_budget_bytes = size_t(8) << 20;
+
+    std::vector<cv::Rect> requested;
+    std::vector<kp::KeyPoint> from_reader, from_image;
+    options.max_parallel_tiles = 1;
+    tile::extractKeypointsTiled(image.size(), [&](const cv::Rect& region, cv::Mat& tile) {
+        requested.push_back(region);
+        image_16U(region).copyTo(tile);
+    }, options, from_reader);
+    tile::extractKeypointsTiled(image, options, from_image);
+
+    EXPECT_FALSE(requested.empty());
+    ASSERT_EQ(from_reader.size(), from_image.size());
+    for (size_t i = 0; i < from_image.size(); ++i) {
+        EXPECT_EQ(from_reader[i].x, from_image[i].x);
+        EXPECT_EQ(from_reader[i].y, from_image[i].y);
+    }
+}
+
+TEST(TiledExtractionTest, RejectsInvalidArguments) {
+    cv::Mat image = createTilingTestImage(64, 64);
+    tile::TilingOptions options = createTilingTestOptions();
+    std::vector<kp::KeyPoint> keypoints;
+
+    options.memory_budget_bytes = 1024;
+    EXPECT_THROW(tile::extractKeypointsTiled(image, options, keypoints), std::invalid_argument);
+
+    options = createTilingTestOptions();
+    options.num_octaves = 0;
+    EXPECT_THROW(tile::extractKeypointsTiled(image, options, keypoints), std::invalid_argument);
+    EXPECT_THROW(tile::extractKeypointsTiled(cv::Mat(), createTilingTestOptions(), keypoints), std::invalid_argument);
+}